@@ -9,6 +9,12 @@ if(PROJECT_IS_TOP_LEVEL)
   option(BUILD_SHARED_LIBS "Build shared libs." OFF)
 endif()
 
+# ---- Category access ----
+
+# Checked access validates every locator coordinate, unchecked validates only
+# the locator dimension and skips the coordinate ranges. Checked by default.
+option(spark_CHECKED_ACCESS "Validate locators in category access" ON)
+
 # ---- Suppress C4251 on Windows ----
 
 # Please see include/spark/spark.hpp for more details
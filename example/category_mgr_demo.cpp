@@ -23,13 +23,13 @@ public:
             return false;
         }
 
-        cat_cal = model()->build_category<ExampleCal>(ExampleCategories::ExampleCal);
-
-        if (cat_cal == nullptr) {
+        if (model()->build_category<ExampleCal>(ExampleCategories::ExampleCal) == nullptr) {
             spdlog::critical("[{}] Cannot build SabatCal category", __PRETTY_FUNCTION__);
             return false;
         }
 
+        cat_cal = model()->handle<ExampleCategories::ExampleCal, ExampleCal>();
+
         pm_cal = db()->get_container<ExampleCalPar>("ExampleCalPar");
         pm_cal->print();
 
@@ -38,40 +38,28 @@ public:
 
     auto execute() -> bool override
     {
-        auto n_objs = cat_raw->get_entries();
-
-        for (int i = 0; i < n_objs; ++i) {
-            auto loc = cat_raw->get_locator(i);
+        for (auto [loc, raw_obj] : cat_raw->view<ExampleRaw>()) {
+            auto new_cal_obj = cat_cal.make_object_unsafe(loc);
 
-            auto raw_obj = cat_raw->get_object<ExampleRaw>(i);
+            fmt::print("CAL Addr: {}\n", std::tuple {raw_obj.board, raw_obj.channel});
 
-            auto new_cal_obj = cat_cal->make_object_unsafe<ExampleCal>(loc);
-
-            fmt::print("CAL Addr: {}\n", std::tuple {raw_obj->board, raw_obj->channel});
-
-            auto [slope, offset] = pm_cal->get({raw_obj->board, raw_obj->channel});
+            auto [slope, offset] = pm_cal->get({raw_obj.board, raw_obj.channel});
 
             fmt::print("CAL Row: {} {}\n", slope, offset);
 
-            new_cal_obj->board = raw_obj->board;
-            new_cal_obj->channel = raw_obj->channel;
+            new_cal_obj->board = raw_obj.board;
+            new_cal_obj->channel = raw_obj.channel;
 
-            new_cal_obj->toa = raw_obj->toa * 0.515;
-            new_cal_obj->energy = raw_obj->tot * 0.123 + 456.;
+            new_cal_obj->toa = raw_obj.toa * 0.515;
+            new_cal_obj->energy = raw_obj.tot * 0.123 + 456.;
         }
 
-        // std::ranges::for_each(*cat_cal,
-        //                       [&](auto& raw_obj)
-        //                       {
-        //                           // FIXME
-        //                       });
-
         return true;
     }
 
 private:
     spark::category* cat_raw {nullptr};
-    spark::category* cat_cal {nullptr};
+    spark::category_handle<ExampleCal> cat_cal;
 
     spark::container_wrapper<ExampleCalPar> pm_cal;
 };
@@ -83,8 +71,7 @@ public:
 
     auto setup_categories(spark::category_manager& cat_mgr) -> void override
     {
-        cat_mgr.register_category(ExampleCategories::ExampleRaw, "ExampleRaw", {64}, true);
-        cat_mgr.register_category(ExampleCategories::ExampleCal, "ExampleCal", {64}, true);
+        cat_mgr.register_model(example_model);
         // cat_mgr.register_category(ExampleCategories::Dummy3d, "Dummy3", {2, 32}, true);
     }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <spark/core/category_model.hpp>
 #include <spark/parameters/lookup.hpp>
 #include <spark/parameters/tabular.hpp>
 
@@ -77,5 +78,9 @@ struct ExampleCal : public TObject
     ClassDef(ExampleCal, 1)
 };
 
+inline constexpr auto example_model = spark::make_model(
+    spark::define_category<ExampleRaw>(ExampleCategories::ExampleRaw, "ExampleRaw", {64}, true, true),
+    spark::define_category<ExampleCal>(ExampleCategories::ExampleCal, "ExampleCal", {64}, true, true));
+
 using ExampleLookup = spark::lookup_table<std::tuple<size_t, size_t>, std::tuple<size_t, size_t>>;
 using ExampleCalPar = spark::tabular_par<std::tuple<size_t, size_t>, std::tuple<int, int>>;
@@ -0,0 +1,40 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#pragma once
+
+#include "spark/spark_config.hpp"
+
+#include <concepts>
+
+namespace spark::policy
+{
+
+/// Validate dimension and every coordinate of the locator, throw on mismatch.
+struct checked
+{
+};
+
+/// Validate only the dimension of the locator, then plain address arithmetic. Out of range coordinate aliases another
+/// cell.
+struct unchecked
+{
+};
+
+template<typename P>
+concept AccessPolicy = std::same_as<P, checked> || std::same_as<P, unchecked>;
+
+/// Policy used by the category methods which do not name one, selected with the spark_CHECKED_ACCESS build option,
+/// checked by default.
+#ifdef spark_CHECKED_ACCESS
+using default_access = checked;
+#else
+using default_access = unchecked;
+#endif
+
+}  // namespace spark::policy
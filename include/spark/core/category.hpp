@@ -10,11 +10,27 @@
 
 #include "spark/spark_export.hpp"
 
+#include "spark/core/access_policy.hpp"
+#include "spark/core/category_view.hpp"
+#include "spark/core/event_arena.hpp"
+#include "spark/core/occupancy_index.hpp"
+#include "spark/core/sparse_index.hpp"
 #include "spark/core/types.hpp"
 #include "spark/utils/demangler.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <initializer_list>
+#include <memory>
+#include <memory_resource>
 #include <numeric>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 #include <Rtypes.h>
 #include <TClass.h>
@@ -31,6 +47,39 @@ namespace spark
 using types::dim_t;
 using locator_t = std::initializer_list<types::loc_t>;
 
+/// Storage of the category objects
+enum class storage_mode : uint8_t
+{
+    dense,   ///< slots preallocated for the whole volume, O(1) lookup by position
+    sparse,  ///< slots allocated for the filled positions only, memory proportional to occupancy
+};
+
+/// Memory held by a category, in bytes
+struct category_memory
+{
+    size_t preallocated {0};  ///< pointer arrays and index structures, scale with the declared shape
+    size_t in_use {0};        ///< objects filled in the current event
+    size_t retained {0};      ///< objects constructed in the array so far, kept for reuse, includes in_use
+    size_t payload {0};       ///< payload arena buffer
+
+    /// Memory used by the current event
+    /// \return size in bytes
+    auto current() const -> size_t { return preallocated + in_use + payload; }
+
+    /// Memory held by the category. Nothing is released before the category is destroyed, so it is also the peak.
+    /// \return size in bytes
+    auto peak() const -> size_t { return preallocated + retained + payload; }
+
+    auto operator+=(const category_memory& other) -> category_memory&
+    {
+        preallocated += other.preallocated;
+        in_use += other.in_use;
+        retained += other.retained;
+        payload += other.payload;
+        return *this;
+    }
+};
+
 namespace details
 {
 
@@ -38,31 +87,101 @@ class SPARK_EXPORT category_internals
 {
 public:
     // header part
-    std::string name;             ///< name of the category
-    bool simulation {false};      ///< simulation category
-    size_t dim {0};               ///< dimensions
-    std::vector<size_t> sizes;    ///< dimension sizes
-    std::vector<size_t> offsets;  ///< dimension offsets
-    size_t data_size {0};         ///< data array size
-    bool writable {false};        ///< is writable
+    std::string name;                         ///< name of the category
+    bool simulation {false};                  ///< simulation category
+    size_t dim {0};                           ///< dimensions
+    std::vector<size_t> sizes;                ///< dimension sizes
+    std::vector<size_t> offsets;              ///< dimension offsets
+    size_t data_size {0};                     ///< data array size
+    bool writable {false};                    ///< is writable
+    storage_mode mode {storage_mode::dense};  ///< storage of the objects
 
 private:
     // index part
-    std::map<size_t, int> idxmap;  ///< map of indexes
+    occupancy_index index;            ///< occupancy of the slots, dense storage
+    sparse_index sparse;              //! filled positions, sparse storage
+    std::vector<size_t> positions;    ///< positions of the compressed objects
+    std::vector<size_t> slots;        //! array slots of the compressed objects before compression, sparse storage
+    std::vector<size_t> locators;     //! decoded locators of the compressed objects
+    std::vector<size_t> batch;        //! positions of the last locators batch
+    std::vector<size_t> batch_slots;  //! array slots of the last locators batch, sparse storage
     // flags
     bool compressed {false};  ///< compressed
 
+    friend auto setup_header(category_internals& header,
+                             const char* name,
+                             std::span<const size_t> sizes,
+                             bool simulation,
+                             storage_mode mode) -> void;
+
 public:
     /**
      * Map uncompressed index pos into compressed index val.
      *
+     * Before compression the mapping is an identity, thus val must be equal to pos. After compression, the mapped
+     * index is a rank of the pos in the occupancy index. For sparse storage val is ignored, use acquire_slot().
+     *
      * \param pos input index of the original coordinate
      * \param val index of the mapped value
      * \return false is the object is compressed and no further indexes can be map
      */
     auto set_map_index(size_t pos, int val) -> bool;
     auto get_map_index(size_t pos) const -> int;
-    auto get_pos_by_index(int idx) -> size_t;
+
+    /**
+     * Mark position as filled and return index of its slot in the objects array. For dense storage the slot is the
+     * position itself, for sparse storage the next free slot is assigned to a new position.
+     *
+     * \param pos uncompressed position
+     * \return slot index or -1 if the category is compressed
+     */
+    auto acquire_slot(size_t pos) -> int;
+
+    /**
+     * Mark all positions as filled in a single sweep. The range is validated once for the whole batch.
+     *
+     * \param poss uncompressed positions
+     * \return slot indexes in order of positions, empty if the category is compressed
+     */
+    auto acquire_slots(std::span<const size_t> poss) -> std::span<const size_t>;
+
+    /**
+     * Return uncompressed position of the object at compressed index idx. Valid only for compressed category.
+     *
+     * \param idx compressed index
+     * \return position
+     */
+    auto get_pos_by_index(int idx) const -> size_t;
+
+    /**
+     * Return uncompressed position of the object in slot idx, for compressed and not compressed category.
+     *
+     * \param idx object index
+     * \return position
+     */
+    auto position_of(size_t idx) const -> size_t;
+
+    /**
+     * Return positions of the filled slots in ascending order. If the category is not compressed yet, the positions
+     * are collected from the occupancy index first. Only for dense storage.
+     *
+     * \return positions
+     */
+    auto filled_positions() -> std::span<const size_t>;
+
+    /**
+     * Return array slots the compressed objects occupied before compression. Valid only for compressed category.
+     *
+     * \return slots, in order of compressed indexes
+     */
+    auto compressed_slots() const -> std::span<const size_t>
+    {
+        return mode == storage_mode::sparse ? std::span<const size_t>(slots) : std::span<const size_t>(positions);
+    }
+
+    /// Is the storage sparse
+    /// \return is sparse
+    auto is_sparse() const -> bool { return mode == storage_mode::sparse; }
 
     /// Is category compressed already
     /// \return compressed
@@ -70,7 +189,11 @@ public:
 
     /// Get number of categories
     /// \return number
-    auto size() const -> size_t { return idxmap.size(); }
+    auto size() const -> size_t;
+
+    /// Heap memory held by the index structures and the buffers
+    /// \return size in bytes
+    auto memory_usage() const -> size_t;
 
     auto clear() -> void;
     auto compress() -> void;
@@ -82,7 +205,7 @@ public:
      * \return success
      */
     template<typename Loc = std::initializer_list<size_t>>
-    constexpr auto check_dim(Loc loc) -> bool
+    constexpr auto check_dim(const Loc& loc) const -> bool
         requires types::LocatorContainer<Loc>
     {
         if (dim != loc.size()) {
@@ -92,23 +215,98 @@ public:
         return true;
     }
 
+    /**
+     * Validate each coordinate of the locator against the dimension sizes. The dimension must be checked before.
+     *
+     * \param loc locator
+     * \throw std::out_of_range if any coordinate exceeds its dimension size
+     */
+    template<typename Loc = std::initializer_list<size_t>>
+    auto check_range(const Loc& loc) const -> void
+        requires types::LocatorContainer<Loc>
+    {
+        auto size_it = sizes.begin();
+        for (auto val : loc) {
+            if (val >= *size_it++) {
+                throw std::out_of_range(
+                    fmt::format("Locator {} out of range of category {} of sizes {}", loc, name, sizes));
+            }
+        }
+    }
+
     /**
      * Translate n-dimension locator loc into linear i coordinate.
      *
+     * The dimension of the locator is always validated. With policy::checked also all coordinates are validated,
+     * with policy::unchecked the caller must guarantee that they are within the dimension sizes.
+     *
      * \param loc locator
      * \return linear coordinate of the array
      */
-    template<typename Loc = std::initializer_list<size_t>>
-    constexpr auto loc2pos(Loc loc) -> size_t
+    template<policy::AccessPolicy Policy = policy::default_access, typename Loc = std::initializer_list<size_t>>
+    constexpr auto loc2pos(const Loc& loc) const -> size_t
         requires types::LocatorContainer<Loc>
     {
         if (!check_dim(loc)) {
             throw std::runtime_error("Dimension mismatch");
         }
 
+        if constexpr (std::is_same_v<Policy, policy::checked>) {
+            check_range(loc);
+        }
+
         return std::inner_product(loc.begin(), loc.end(), offsets.begin(), types::loc_t {});
     }
 
+    /**
+     * Translate a batch of locators into linear positions. The dimensions of all locators are validated before any
+     * position is computed, for fixed size locators (e.g. std::array) only once. With policy::checked also all
+     * coordinates are validated.
+     *
+     * \param locs locators
+     * \return linear positions, valid until next call
+     */
+    template<policy::AccessPolicy Policy = policy::default_access, typename Loc>
+    auto locs2pos(std::span<const Loc> locs) -> std::span<const size_t>
+        requires types::LocatorContainer<Loc>
+    {
+        if constexpr (concepts::TupleLike<Loc>) {
+            if (std::tuple_size_v<Loc> != dim) {
+                spdlog::critical(
+                    "Dimension of locator = {:d} does not fit to category of = {:d}\n", std::tuple_size_v<Loc>, dim);
+                throw std::runtime_error("Dimension mismatch");
+            }
+        } else {
+            if (!std::ranges::all_of(locs, [this](const Loc& loc) { return loc.size() == dim; })) {
+                spdlog::critical("Dimension of locators batch does not fit to category of = {:d}\n", dim);
+                throw std::runtime_error("Dimension mismatch");
+            }
+        }
+
+        if constexpr (std::is_same_v<Policy, policy::checked>) {
+            for (const auto& loc : locs) {
+                check_range(loc);
+            }
+        }
+
+        batch.resize(locs.size());
+        std::ranges::transform(locs,
+                               batch.begin(),
+                               [this](const Loc& loc)
+                               {
+                                   return std::inner_product(loc.begin(), loc.end(), offsets.begin(), types::loc_t {});
+                               });
+
+        return batch;
+    }
+
+    /**
+     * Decode locators of all compressed objects into flat array of dim values per object.
+     *
+     * \return flattened locators
+     */
+    auto decode_locators() -> std::span<const size_t>;
+
     /**
      * Converts uncompressed position into vector of locator values.
      *
@@ -127,6 +325,12 @@ public:
 
         return ret_val;
     }
+
+private:
+    /// Restore the occupancy index from the compressed positions after reading
+    auto restore_index() -> void;
+
+    ClassDefNV(category_internals, 2)
 };
 
 /**
@@ -137,14 +341,43 @@ public:
  * \param dim number of dimensions
  * \param sizes array of sizes of dimensions
  * \param simulation set true if category for simulation data
+ * \param mode objects storage
  */
 SPARK_EXPORT auto setup_header(category_internals& header,
                                const char* name,
-                               std::initializer_list<size_t> sizes,
-                               bool simulation) -> void;
+                               std::span<const size_t> sizes,
+                               bool simulation,
+                               storage_mode mode = storage_mode::dense) -> void;
+
+inline auto setup_header(category_internals& header,
+                         const char* name,
+                         std::initializer_list<size_t> sizes,
+                         bool simulation,
+                         storage_mode mode = storage_mode::dense) -> void
+{
+    setup_header(header, name, std::span<const size_t> {sizes.begin(), sizes.size()}, simulation, mode);
+}
 
 }  // namespace details
 
+template<policy::AccessPolicy Policy>
+class category_access;
+
+/**
+ * Opt-in for classes whose members, except the TObject base, are trivially copyable. In the recycling mode such objects
+ * are reset by copying the members of a default constructed prototype, see category::set_recycling(). TObject must be
+ * the first base class.
+ *
+ *     template<>
+ *     inline constexpr bool spark::trivially_resettable<SomeClass> = true;
+ */
+template<typename T>
+inline constexpr bool trivially_resettable = false;
+
+/// Class provides a cheap reset() to the default state, used in the recycling mode instead of the constructor.
+template<typename T>
+concept Resettable = requires(T& obj) { obj.reset(); };
+
 // template<size_t N>
 // struct SPARK_EXPORT basic_category : public TObject
 // {
@@ -156,8 +389,14 @@ class SPARK_EXPORT category : public TObject
 {
 private:
     // members
-    details::category_internals header;  ///< header information
-    TClonesArray* data {nullptr};        ///<-> holds category data
+    details::category_internals header;                   ///< header information
+    TClonesArray* data {nullptr};                         ///<-> holds category data
+    std::unique_ptr<details::event_arena> payload_arena;  //! memory of objects payload, reset on clear
+    std::vector<TObject*> scratch;                        //! objects reordering buffer
+    std::vector<uint8_t>* touch_list {nullptr};           //! list of categories filled in the event, not owned
+    uint8_t touch_id {0};                                 //! ID reported to the touch_list
+    bool touched {false};                                 //! already reported in this event
+    bool recycling {false};                               //! objects are reused without Clear() and constructor
 
 public:
     // constructors
@@ -169,8 +408,17 @@ public:
      * \param tclass TClass object
      * \param sizes array of sizes of dimensions
      * \param simulation set true if category for simulation data
+     * \param mode objects storage, sparse storage does not preallocate the whole volume
      */
-    category(TClass* tclass, std::initializer_list<size_t> sizes, bool simulation);
+    category(TClass* tclass, std::span<const size_t> sizes, bool simulation, storage_mode mode = storage_mode::dense);
+
+    category(TClass* tclass,
+             std::initializer_list<size_t> sizes,
+             bool simulation,
+             storage_mode mode = storage_mode::dense)
+        : category(tclass, std::span<const size_t> {sizes.begin(), sizes.size()}, simulation, mode)
+    {
+    }
 
     category(const category&) = delete;
     category(category&&) = delete;
@@ -195,13 +443,6 @@ public:
     auto get_slot(Loc loc) -> T*&
         requires types::LocatorContainer<Loc>
     {
-        const auto pos = header.loc2pos(loc);
-
-        if (!header.set_map_index(pos, pos)) {
-            spdlog::warn("Category {} was already compressed, can't add new slots.", header.name);
-            throw std::runtime_error("Cannot access compressed category");
-        }
-
         // if (get_object<T>(loc) == nullptr) {
         //     throw std::runtime_error(std::format("Cannot read object {} at given location {} in {}:{}",
         //                                          typeid(T).name(),
@@ -211,7 +452,20 @@ public:
         //     // return {};  // FIXME what here?
         // };
 
-        return reinterpret_cast<T*&>(data->operator[](types::size_t2int(pos)));
+        return get_slot_at<T>(locate(loc));
+    }
+
+    /**
+     * Returns a reference to an object at the linear position pos. The position must be already validated by the
+     * caller, e.g. computed by static_category.
+     *
+     * \param pos linear position
+     * \return reference to a slot
+     */
+    template<typename T>
+    auto get_slot_at(size_t pos) -> T*&
+    {
+        return reinterpret_cast<T*&>(data->operator[](take_slot(pos)));
     }
 
     /**
@@ -245,7 +499,18 @@ public:
     auto get_object(Loc loc) -> T*
         requires types::LocatorContainer<Loc>
     {
-        auto pos = header.loc2pos(loc);
+        return get_object_at<T>(locate(loc));
+    }
+
+    /**
+     * Returns object at the given linear position.
+     *
+     * \param pos linear position
+     * \return pointer to the object or nullptr if slot is empty
+     */
+    template<typename T>
+    auto get_object_at(size_t pos) -> T*
+    {
         auto map_pos = header.get_map_index(pos);
         if (map_pos < 0) {
             return nullptr;
@@ -270,6 +535,23 @@ public:
         return dynamic_cast<T*>(data->At(idx));
     }
 
+    /**
+     * Returns object at given index idx without the class check. The caller must guarantee that the category stores
+     * objects of T, e.g. category_handle.
+     *
+     * \param idx index
+     * \return pointer to the object
+     */
+    template<typename T>
+    auto get_object_unchecked(int idx) -> T*
+    {
+        if (!header.is_compressed()) {
+            compress();
+        }
+
+        return static_cast<T*>(data->At(idx));
+    }
+
     /**
      * Takes slot and creates object at given location.
      *
@@ -287,9 +569,76 @@ public:
     auto make_object_unsafe(Loc loc) -> T*
         requires types::LocatorContainer<Loc>
     {
-        auto obj = get_slot<T>(loc);
-        new (obj) T();
-        return obj;
+        return make_object_at<T>(locate(loc));
+    }
+
+    /**
+     * Takes slot and creates object at given linear position. Same rules as for make_object_unsafe() apply.
+     *
+     * \param pos linear position
+     * \return pointer to the object
+     */
+    template<typename T>
+    auto make_object_at(size_t pos) -> T*
+    {
+        return emplace<T>(take_slot(pos));
+    }
+
+    /**
+     * Takes slots and creates objects at all given locations at once. With checked access the dimensions are validated
+     * once, positions are computed in a single pass and the occupancy index is updated in one sweep. Same rules as for
+     * make_object_unsafe() apply to each location.
+     *
+     *     std::vector<std::array<size_t, 2>> locs = decode_frame(...);
+     *     auto hits = cat->make_objects<SomeClass>(locs);
+     *
+     * \param locs contiguous range of locators, e.g. std::span<const locator>
+     * \return pointers to the objects, in order of locators
+     */
+    template<typename T, policy::AccessPolicy Policy = policy::default_access, std::ranges::contiguous_range R>
+    auto make_objects(const R& locs) -> std::vector<T*>
+        requires types::LocatorContainer<std::ranges::range_value_t<R>>
+    {
+        const auto poss = header.locs2pos<Policy>(std::span<const std::ranges::range_value_t<R>>(locs));
+
+        if (header.is_compressed()) {
+            spdlog::warn("Category {} was already compressed, can't add new slots.", header.name);
+            throw std::runtime_error("Cannot access compressed category");
+        }
+
+        if (!poss.empty()) {
+            mark_touched();
+        }
+
+        std::vector<T*> objs;
+        objs.reserve(poss.size());
+        for (auto slot : header.acquire_slots(poss)) {
+            objs.push_back(emplace<T>(types::size_t2int(slot)));
+        }
+
+        return objs;
+    }
+
+    /**
+     * Returns objects at all given locations.
+     *
+     * \param locs contiguous range of locators, e.g. std::span<const locator>
+     * \return pointers to the objects or nullptr for empty slots, in order of locators
+     */
+    template<typename T, policy::AccessPolicy Policy = policy::default_access, std::ranges::contiguous_range R>
+    auto get_objects(const R& locs) -> std::vector<T*>
+        requires types::LocatorContainer<std::ranges::range_value_t<R>>
+    {
+        const auto poss = header.locs2pos<Policy>(std::span<const std::ranges::range_value_t<R>>(locs));
+
+        std::vector<T*> objs;
+        objs.reserve(poss.size());
+        for (auto pos : poss) {
+            auto map_pos = header.get_map_index(pos);
+            objs.push_back(map_pos < 0 ? nullptr : static_cast<T*>(data->At(map_pos)));
+        }
+
+        return objs;
     }
 
     /**
@@ -301,27 +650,80 @@ public:
     auto make_next_object() -> T*
     {
         auto obj = get_next_slot<T>();
-        const std::tuple ttt = {get_entries()};
-        new (obj) T();
-        return obj;
+        return construct(obj);
     }
 
     /**
-     * Get locator for given object index.
+     * Translate locator into linear position using given access policy.
+     *
+     * \param loc locator
+     * \return linear position
      */
-    auto get_locator(types::dim_t idx) -> std::vector<types::dim_t>
+    template<policy::AccessPolicy Policy = policy::default_access, typename Loc = std::initializer_list<size_t>>
+    auto locate(const Loc& loc) const -> size_t
+        requires types::LocatorContainer<Loc>
     {
-        return header.pos2loc(header.is_compressed() ? header.get_pos_by_index(types::size_t2int(idx)) : idx);
+        return header.loc2pos<Policy>(loc);
     }
 
+    /**
+     * Returns accessor of the category with the given access policy, independent of the build default.
+     *
+     *     cat->access<spark::policy::checked>().make_object_unsafe<SomeClass>({0, 1, 2});
+     *
+     * \return accessor
+     */
+    template<policy::AccessPolicy Policy>
+    auto access() -> category_access<Policy>;
+
+    /**
+     * Get linear position of the object at given index.
+     *
+     * \param idx object index
+     * \return position in the uncompressed array
+     */
+    auto get_position(types::dim_t idx) const -> size_t
+    {
+        return header.position_of(idx);
+    }
+
+    /**
+     * Get locator for given object index.
+     */
+    auto get_locator(types::dim_t idx) -> std::vector<types::dim_t> { return header.pos2loc(get_position(idx)); }
+
     /// Returns name of the container
     /// \return container name
     auto get_name() const -> TString { return header.name; }
 
+    /// Returns sizes of the container dimensions
+    /// \return dimension sizes
+    auto get_sizes() const -> const std::vector<size_t>& { return header.sizes; }
+
+    /// Returns class of the stored objects
+    /// \return class
+    auto get_class() const -> TClass* { return data->GetClass(); }
+
     /// Returns number of entries in the category
     /// \return number of entries
     auto get_entries() const -> Int_t { return data->GetEntries(); }
 
+    /// Returns number of filled slots, O(1) unlike get_entries()
+    /// \return number of filled slots
+    auto size() const -> size_t { return header.size(); }
+
+    /// Returns size of the category volume
+    /// \return number of positions
+    auto get_data_size() const -> size_t { return header.data_size; }
+
+    /**
+     * Memory held by the category. The constructed objects are counted by walking over the array, so it is meant for
+     * the statistics, not for use at each event.
+     *
+     * \return memory usage
+     */
+    auto memory_usage() const -> category_memory;
+
     /// \sa TObject::IsFolder()
     /// \return is a folder
     auto IsFolder() const -> Bool_t override { return kTRUE; }
@@ -341,11 +743,246 @@ public:
 
     auto print() const -> void;
 
+    /**
+     * Returns typed view over the compressed entries. Each element is a pair of locator and reference to the object.
+     * The class T is checked once here, the element access does not involve any cast checks. Compresses the category
+     * if not compressed yet.
+     *
+     *     for (auto [loc, obj] : cat->view<ExampleRaw>()) { ... }
+     *
+     * \return view of the category
+     */
+    template<typename T>
+    auto view() -> category_view<T>
+    {
+        if (!stores<T>()) {
+            throw std::runtime_error(
+                fmt::format("Category {} does not store objects of class {}", header.name, typeid(T).name()));
+        }
+
+        return view_unchecked<T>();
+    }
+
+    /**
+     * Same as view() but without the class check. The caller must guarantee that the category stores objects of T,
+     * e.g. category_handle.
+     *
+     * \return view of the category
+     */
+    template<typename T>
+    auto view_unchecked() -> category_view<T>
+    {
+        if (!header.is_compressed()) {
+            compress();
+        }
+
+        return {data, header.decode_locators(), header.dim};
+    }
+
+    /**
+     * Check whether the category stores objects of class T or derived from it.
+     *
+     * \return class matches
+     */
+    template<typename T>
+    auto stores() const -> bool
+    {
+        return data->GetClass()->InheritsFrom(TClass::GetClass<T>());
+    }
+
+    /**
+     * Memory resource for the payload of the objects, valid until the category is cleared. Objects constructible from
+     * std::pmr::memory_resource* receive it automatically when created with make_object_unsafe() and similar.
+     *
+     *     struct Waveform : TObject {
+     *         Waveform(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : samples {mr} {}
+     *         std::pmr::vector<float> samples;  //!
+     *     };
+     *
+     * At clear() the objects are destroyed and default constructed again before the arena is released, the recycling
+     * does not apply to them. The payload members must be transient (//!), the arena memory is never persisted. The
+     * elements of the payload containers must be trivially destructible, e.g. numbers or plain structs, so that the
+     * destruction does not visit them and the release of the whole payload costs only the reset of the arena.
+     *
+     * \return arena resource
+     */
+    auto arena() -> std::pmr::memory_resource*
+    {
+        if (!payload_arena) {
+            payload_arena = std::make_unique<details::event_arena>();
+        }
+        return payload_arena->resource();
+    }
+
+    /**
+     * Report the first filled slot of each event by appending id to the list. Used by the category_manager, so that
+     * clear() and compress() visit only the categories filled in the event. The flag is reset by clear().
+     *
+     * \param list list of touched categories, must outlive the category, nullptr disables the reporting
+     * \param id value appended to the list
+     */
+    auto set_touch_list(std::vector<uint8_t>* list, uint8_t id) -> void
+    {
+        touch_list = list;
+        touch_id = id;
+    }
+
+    /// Was any slot created since last clear
+    /// \return touched
+    auto is_touched() const -> bool { return touched; }
+
+    /**
+     * Recycling mode. The clear() only marks all slots free, without calling Clear() of the objects. Objects created
+     * again in a slot used in a previous event are reset instead of constructed: with reset() if the class is
+     * Resettable, by copying a prototype if it is trivially_resettable, otherwise with the deferred Clear() and the
+     * constructor. Objects using the payload arena are always constructed, as their payload is released by clear().
+     *
+     * The make_* functions handle the recycling, objects placed by the caller into get_slot() are not recycled.
+     *
+     * \param enable enable recycling
+     */
+    auto set_recycling(bool enable) -> void { recycling = enable; }
+
+    /// Is recycling mode enabled
+    /// \return recycling
+    auto is_recycling() const -> bool { return recycling; }
+
     auto begin() -> TIter { return data->begin(); }
 
-    auto end() -> TIter { return data->begin(); }
+    auto end() -> TIter { return data->end(); }
+
+private:
+    auto mark_touched() -> void
+    {
+        if (!touched) {
+            touched = true;
+            if (touch_list != nullptr) {
+                touch_list->push_back(touch_id);
+            }
+        }
+    }
+
+    /// Acquire slot of the position and mark the category touched
+    /// \param pos linear position
+    /// \return slot index
+    auto take_slot(size_t pos) -> Int_t
+    {
+        const auto slot = header.acquire_slot(pos);
+        if (slot < 0) {
+            spdlog::warn("Category {} was already compressed, can't add new slots.", header.name);
+            throw std::runtime_error("Cannot access compressed category");
+        }
 
-    ClassDefOverride(category, 1)
+        mark_touched();
+        return slot;
+    }
+
+    /// Does the slot hold an object constructed in a previous event
+    auto is_constructed(Int_t slot) const -> bool;
+
+    /// Create object in the slot, recycle the previous one if possible
+    template<typename T>
+    auto emplace(Int_t slot) -> T*
+    {
+        const auto reuse = recycling and is_constructed(slot);
+        auto*& obj = reinterpret_cast<T*&>(data->operator[](slot));
+        return reuse ? recycle(obj) : construct(obj);
+    }
+
+    template<typename T>
+    auto construct(T* obj) -> T*
+    {
+        if constexpr (std::is_constructible_v<T, std::pmr::memory_resource*>) {
+            new (obj) T(arena());
+        } else {
+            new (obj) T();
+        }
+        return obj;
+    }
+
+    template<typename T>
+    auto recycle(T* obj) -> T*
+    {
+        if constexpr (std::is_constructible_v<T, std::pmr::memory_resource*>) {
+            return construct(obj);
+        } else if constexpr (Resettable<T>) {
+            obj->reset();
+        } else if constexpr (trivially_resettable<T>) {
+            static_assert(std::is_base_of_v<TObject, T>, "Trivially resettable class must inherit from TObject");
+            static const T prototype {};
+            std::memcpy(reinterpret_cast<char*>(obj) + sizeof(TObject),
+                        reinterpret_cast<const char*>(&prototype) + sizeof(TObject),
+                        sizeof(T) - sizeof(TObject));
+        } else {
+            obj->Clear("");
+            construct(obj);
+        }
+
+        obj->ResetBit(TObject::kHasUUID);
+        obj->ResetBit(TObject::kIsReferenced);
+        obj->SetUniqueID(0);
+        return obj;
+    }
+
+    ClassDefOverride(category, 2)
+};
+
+/**
+ * \class category_access
+ * \ingroup lib_core
+ *
+ * Locator based access to a category with explicitly selected access policy, see category::access().
+ */
+template<policy::AccessPolicy Policy>
+class category_access
+{
+public:
+    explicit category_access(category* cat)
+        : cat_ptr {cat}
+    {
+    }
+
+    template<typename T, typename Loc = std::initializer_list<size_t>>
+    auto get_slot(const Loc& loc) -> T*&
+        requires types::LocatorContainer<Loc>
+    {
+        return cat_ptr->get_slot_at<T>(cat_ptr->locate<Policy>(loc));
+    }
+
+    template<typename T, typename Loc = std::initializer_list<size_t>>
+    auto get_object(const Loc& loc) -> T*
+        requires types::LocatorContainer<Loc>
+    {
+        return cat_ptr->get_object_at<T>(cat_ptr->locate<Policy>(loc));
+    }
+
+    template<typename T, typename Loc = std::initializer_list<size_t>>
+    auto make_object_unsafe(const Loc& loc) -> T*
+        requires types::LocatorContainer<Loc>
+    {
+        return cat_ptr->make_object_at<T>(cat_ptr->locate<Policy>(loc));
+    }
+
+    template<typename T, std::ranges::contiguous_range R>
+    auto make_objects(const R& locs) -> std::vector<T*>
+    {
+        return cat_ptr->make_objects<T, Policy>(locs);
+    }
+
+    template<typename T, std::ranges::contiguous_range R>
+    auto get_objects(const R& locs) -> std::vector<T*>
+    {
+        return cat_ptr->get_objects<T, Policy>(locs);
+    }
+
+private:
+    category* cat_ptr {nullptr};  ///< accessed category
 };
 
+template<policy::AccessPolicy Policy>
+auto category::access() -> category_access<Policy>
+{
+    return category_access<Policy>(this);
+}
+
 }  // namespace spark
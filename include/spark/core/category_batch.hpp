@@ -0,0 +1,107 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#pragma once
+
+#include "spark/core/category.hpp"
+#include "spark/core/category_view.hpp"
+
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace spark
+{
+
+/**
+ * \class category_batch
+ * \ingroup lib_core
+ *
+ * Typed access to one category over all events of the current batch, created by category_manager::batch_handle().
+ *
+ * Each event of the batch is stored in its own category object, so the per-event API stays unchanged and the event
+ * view is a regular category_view. The objects are not contiguous across the events, the offsets() only number them
+ * batch wide, e.g. for column_category::gather().
+ *
+ *     auto hits = model()->batch_handle<ExampleCategories::ExampleRaw, ExampleRaw>();
+ *     for (size_t evt = 0; evt < hits.size(); ++evt) {
+ *         for (auto [loc, obj] : hits.event(evt)) { ... }
+ *     }
+ */
+template<typename T>
+class category_batch
+{
+public:
+    category_batch() = default;
+
+    /**
+     * Constructor. The class must be already verified by the caller.
+     *
+     * \param cats category object of each event slot
+     * \param events address of the number of events in the current batch
+     */
+    category_batch(std::vector<category*> cats, const size_t* events)
+        : categories {std::move(cats)}
+        , n_events {events}
+    {
+    }
+
+    /// Number of events in the current batch
+    /// \return number of events
+    auto size() const -> size_t { return *n_events; }
+
+    /// Category of given event of the batch
+    /// \param evt event index in the batch
+    /// \return category
+    auto get(size_t evt) const -> category* { return categories[evt]; }
+
+    /// Typed view of given event, compresses the event category
+    /// \param evt event index in the batch
+    /// \return view
+    auto event(size_t evt) const -> category_view<T> { return categories[evt]->template view_unchecked<T>(); }
+
+    /**
+     * Offsets of the first object of each event in the batch, followed by the total number of objects. Compresses the
+     * event categories.
+     *
+     * \return size() + 1 offsets
+     */
+    auto offsets() -> std::span<const size_t>
+    {
+        event_offsets.resize(size() + 1);
+        event_offsets[0] = 0;
+        for (size_t evt = 0; evt < size(); ++evt) {
+            categories[evt]->compress();
+            event_offsets[evt + 1] = event_offsets[evt] + categories[evt]->size();
+        }
+        return event_offsets;
+    }
+
+    /**
+     * Call func(evt, loc, obj) for each object of each event of the batch.
+     *
+     * \param func callable
+     */
+    template<typename F>
+    auto for_each(F&& func) const -> void
+    {
+        for (size_t evt = 0; evt < size(); ++evt) {
+            for (auto [loc, obj] : event(evt)) {
+                func(evt, loc, obj);
+            }
+        }
+    }
+
+private:
+    std::vector<category*> categories;  ///< category object of each event slot
+    const size_t* n_events {nullptr};   ///< number of events in the batch, owned by the category manager
+    std::vector<size_t> event_offsets;  ///< result of offsets()
+};
+
+}  // namespace spark
@@ -0,0 +1,97 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#pragma once
+
+#include "spark/core/category.hpp"
+#include "spark/core/category_view.hpp"
+#include "spark/core/types.hpp"
+
+#include <initializer_list>
+
+namespace spark
+{
+
+/**
+ * \class category_handle
+ * \ingroup lib_core
+ *
+ * Typed access to a category, created by category_manager::handle().
+ *
+ * The class of the stored objects is verified once, when the handle is created. The accessors forward directly to the
+ * position based category methods, without any class check, lookup or dynamic cast. The handle refers to the category
+ * pointer kept by the category manager, so it follows the category object if the pointer is replaced, e.g. by the
+ * reader.
+ *
+ *     auto cat_cal = model()->handle<ExampleCategories::ExampleCal, ExampleCal>();
+ *     auto obj = cat_cal.make_object_unsafe({12});
+ */
+template<typename T>
+class category_handle
+{
+public:
+    category_handle() = default;
+
+    /**
+     * Constructor. The class must be already verified by the caller.
+     *
+     * \param cat_slot address of the category pointer
+     */
+    explicit category_handle(category* const* cat_slot)
+        : slot {cat_slot}
+    {
+    }
+
+    template<typename Loc = std::initializer_list<size_t>>
+    auto get_slot(const Loc& loc) const -> T*&
+        requires types::LocatorContainer<Loc>
+    {
+        return get()->template get_slot_at<T>(get()->locate(loc));
+    }
+
+    template<typename Loc = std::initializer_list<size_t>>
+    auto get_object(const Loc& loc) const -> T*
+        requires types::LocatorContainer<Loc>
+    {
+        return get()->template get_object_at<T>(get()->locate(loc));
+    }
+
+    template<typename Loc = std::initializer_list<size_t>>
+    auto make_object_unsafe(const Loc& loc) const -> T*
+        requires types::LocatorContainer<Loc>
+    {
+        return get()->template make_object_at<T>(get()->locate(loc));
+    }
+
+    auto make_next_object() const -> T* { return get()->template make_next_object<T>(); }
+
+    /// Returns object at given index of compressed category
+    /// \param idx object index
+    /// \return object
+    auto at(int idx) const -> T* { return get()->template get_object_unchecked<T>(idx); }
+
+    /// Typed view of the category, see category::view()
+    /// \return view
+    auto view() const -> category_view<T> { return get()->template view_unchecked<T>(); }
+
+    auto get_entries() const -> Int_t { return get()->get_entries(); }
+
+    /// Returns the category
+    /// \return category
+    auto get() const -> category* { return *slot; }
+
+    auto operator->() const -> category* { return *slot; }
+
+    /// Is handle bound to existing category
+    explicit operator bool() const { return slot != nullptr and *slot != nullptr; }
+
+private:
+    category* const* slot {nullptr};  ///< category pointer owned by the category manager
+};
+
+}  // namespace spark
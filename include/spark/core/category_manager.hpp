@@ -11,18 +11,52 @@
 #include "spark/spark_config.hpp"
 #include "spark/spark_export.hpp"
 
+#include "spark/core/category_batch.hpp"
+#include "spark/core/category_handle.hpp"
+#include "spark/core/category_model.hpp"
 #include "spark/core/detector.hpp"
 #include "spark/core/detector_manager.hpp"
+#include "spark/core/static_category.hpp"
+#include "spark/utils/thread_pool.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <format>
-#include <map>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <spdlog/spdlog.h>
 
 namespace spark
 {
 
+/// Occupancy of a category over the events compressed by the category manager
+struct category_stats
+{
+    size_t first_event {0};  ///< events compressed by the manager before the category was built
+    size_t events {0};       ///< events compressed since the category was built
+    size_t filled_sum {0};   ///< filled slots summed over the events
+    size_t filled_max {0};   ///< largest number of filled slots in an event
+
+    /// Mean number of filled slots per event
+    /// \return mean
+    auto mean_filled() const -> double
+    {
+        return events ? static_cast<double>(filled_sum) / static_cast<double>(events) : 0.0;
+    }
+};
+
 struct category_info  ///< Category info
 {
     category_info() = default;
@@ -35,23 +69,37 @@ struct category_info  ///< Category info
 
     ~category_info() = default;
 
-    bool registered {false};              ///< Category is registered
-    bool persistent {false};              ///< Category is persistent
-    uint16_t cat_id {0};                  ///< Category ID
-    std::string name;                     ///< Category name
-    bool simulation {false};              ///< Simulation run
-    std::initializer_list<size_t> sizes;  ///< Dimensions sizes
-    std::unique_ptr<category> obj;        ///< Category object
-    category* ptr {nullptr};              ///< Pointer to category object
+    /// Sizes of the used dimensions
+    /// \return sizes
+    auto shape() const -> std::span<const size_t> { return {sizes.data(), dim}; }
+
+    bool registered {false};                         ///< Category is registered
+    bool persistent {false};                         ///< Category is persistent
+    uint16_t cat_id {0};                             ///< Category ID
+    std::string_view name;                           ///< Category name
+    std::string name_storage;                        ///< Owns the name of category registered at runtime
+    bool simulation {false};                         ///< Simulation run
+    std::array<size_t, max_category_dim> sizes {};   ///< Dimensions sizes
+    size_t dim {0};                                  ///< Number of dimensions
+    TClass* tclass {nullptr};                        ///< Class of objects declared by the model, if any
+    copy_objects_fn copy_objects {nullptr};          ///< Copy of the objects by value, set when the class is known
+    storage_mode mode {storage_mode::dense};         ///< Objects storage
+    bool recycling {false};                          ///< Objects are recycled, see category::set_recycling()
+    std::unique_ptr<category> obj;                   ///< Category object
+    category* ptr {nullptr};                         ///< Pointer to category object
+    category* input {nullptr};                       ///< Category object filled by the sources
+    category* output {nullptr};                      ///< Category object written to the output
+    std::vector<std::unique_ptr<category>> buffers;  ///< Category objects of additional event buffers
+    category_stats stats;                            ///< Occupancy statistics
 };
 }  // namespace spark
 
 template<>
-struct std::formatter<spark::category_info> : std::formatter<std::string>
+struct std::formatter<spark::category_info> : std::formatter<std::string_view>
 {
     auto format(const spark::category_info& cinfo, format_context& ctx) const -> format_context::iterator
     {
-        return formatter<std::string>::format(cinfo.name, ctx);
+        return formatter<std::string_view>::format(cinfo.name, ctx);
     }
 };
 
@@ -73,19 +121,30 @@ class sparksys;
 class category_manager
 {
 public:
+    /// Size of the registry, one entry per possible category ID
+    static constexpr size_t max_categories = size_t {std::numeric_limits<uint8_t>::max()} + 1;
+
+    /// Default number of objects in the event above which the parallel mode is used
+    static constexpr size_t default_parallel_threshold = 2048;
+
+    /// Maximal number of event buffers, limits the batch size as well
+    static constexpr size_t max_buffers = 64;
+
+    /// Default limit of the memory preallocated by the dense categories of all events of the batch, in bytes
+    static constexpr size_t default_batch_memory = size_t {256} << 20;
+
     category_manager() = default;
 
     /**
-     * Get reference to the category_info object. Throws std::out_of_range if category not registered yet.
+     * Get reference to the category_info object. The registered flag tells whether category was registered already.
      *
      * \param cat category ID
      * \return reference to the category_info object
      */
-    template<typename ECategories>
+    template<CategoryEnum ECategories>
     auto get_category_info(ECategories cat) -> category_info&
     {
-        auto pos = get_category_index(cat);
-        return cinfovec[pos];
+        return registry[get_category_index(cat)];
     }
 
     /**
@@ -100,59 +159,178 @@ public:
      * \param name category name
      * \param sizes sizes of dimension
      * \param simulation simulation run
+     * \param mode objects storage, use storage_mode::sparse for huge, sparsely filled volumes
      * \return success
      */
-    template<typename ECategories>
+    template<CategoryEnum ECategories>
     auto register_category(ECategories cat,
                            const std::string& name,
                            std::initializer_list<size_t> sizes,
-                           bool simulation) -> bool
+                           bool simulation,
+                           storage_mode mode = storage_mode::dense) -> bool
     {
         auto pos = get_category_index(cat);
 
-        try {
-            return cinfovec.at(pos).registered == true;
-        } catch (std::out_of_range&) {
-            auto& cinfo = cinfovec[pos];
-            cinfo.registered = true;
-            cinfo.cat_id = pos;
-            cinfo.name = name;
-            cinfo.simulation = simulation;
-            cinfo.sizes = sizes;
-            spdlog::info(
-                "    -> Category {} registered with sizes: {}  sim: {} in {}", name, sizes, simulation, (void*)this);
+        auto& cinfo = registry[pos];
+        if (cinfo.registered) {
+            return true;
+        }
+
+        if (sizes.size() == 0 or sizes.size() > max_category_dim) {
+            throw std::out_of_range(
+                std::format("Category {} must have from 1 to {} dimensions", name, max_category_dim));
         }
+
+        cinfo.name_storage = name;
+        cinfo.name = cinfo.name_storage;
+        cinfo.persistent = true;
+        std::ranges::copy(sizes, cinfo.sizes.begin());
+        cinfo.dim = sizes.size();
+        fill_info(cinfo, pos, simulation, mode);
+
         return true;
     }
 
     /**
-     * Build category based on its ID. Category must be first registered.
+     * Register all categories of the compile-time model. The model is verified already, the names are not copied, thus
+     * the model must outlive the category manager, which is the case of constexpr variables.
+     *
+     * Already registered categories are skipped.
+     *
+     * \param model categories model
+     * \return success
+     */
+    template<CategoryEnum ECategories, size_t N>
+    auto register_model(const category_model<ECategories, N>& model) -> bool
+    {
+        for (const auto& def : model) {
+            auto pos = get_category_index(def.cat);
+
+            auto& cinfo = registry[pos];
+            if (cinfo.registered) {
+                continue;
+            }
+
+            cinfo.name = def.name;
+            cinfo.persistent = def.persistent;
+            cinfo.sizes = def.sizes;
+            cinfo.dim = def.dim;
+            cinfo.tclass = def.get_class();
+            cinfo.copy_objects = def.copy_objects;
+            fill_info(cinfo, pos, def.simulation, def.mode);
+        }
+
+        return true;
+    }
+
+    /**
+     * Build all categories of the model with the classes and persistence declared there. The model must be
+     * registered first.
+     *
+     * \param model categories model
+     */
+    template<CategoryEnum ECategories, size_t N>
+    auto build_model(const category_model<ECategories, N>& model) -> void
+    {
+        for (const auto& def : model) {
+            build_category_class(get_category_index(def.cat), def.get_class(), def.persistent);
+        }
+    }
+
+    /**
+     * Build category based on its ID. Category must be first registered. If the category comes from the model, T must
+     * match the declared class.
      *
      * \param cat category ID
-     * \param persistent set category persistent
+     * \param persistent set category persistent, by default as registered (true for runtime registration)
      * \return pointer to category object
      */
-    template<typename T, typename ECategories>
-    auto build_category(ECategories cat, bool persistent = true) -> category*
+    template<typename T, CategoryEnum ECategories>
+    auto build_category(ECategories cat, std::optional<bool> persistent = std::nullopt) -> category*
     {
         auto pos = get_category_index(cat);
-        try {
-            return categories.at(pos);
-        } catch (...) {
-        }
 
-        auto& cinfo = cinfovec[pos];
-        if (!cinfo.registered) {
-            throw std::out_of_range(std::format("Category with id {} not registered", pos));
+        auto& cinfo = registry[pos];
+        if (cinfo.tclass and cinfo.tclass != TClass::GetClass<T>()) {
+            throw std::runtime_error(std::format("Category {} is declared with class {}, not {}",
+                                                 cinfo.name,
+                                                 cinfo.tclass->GetName(),
+                                                 TClass::GetClass<T>()->GetName()));
         }
 
-        cinfo.persistent = persistent;
-        cinfo.obj = std::make_unique<category>(TClass::GetClass<T>(), cinfo.sizes, cinfo.simulation);
-        cinfo.ptr = cinfo.obj.get();
-        categories[pos] = cinfo.ptr;
-        cat_name[pos] = cinfo.name;
+        cinfo.copy_objects = objects_copier<T>();
+        return build_category_class(pos, TClass::GetClass<T>(), persistent.value_or(cinfo.persistent));
+    }
 
-        return cinfo.ptr;
+    /**
+     * Build category based on its ID and wrap it into compile-time shaped static_category. The registered sizes must
+     * match the static ones.
+     *
+     * \param cat category ID
+     * \param persistent set category persistent
+     * \return static category object
+     */
+    template<typename T, size_t... Sizes, CategoryEnum ECategories>
+    auto build_static_category(ECategories cat, std::optional<bool> persistent = std::nullopt)
+        -> static_category<T, Sizes...>
+    {
+        return static_category<T, Sizes...>(build_category<T>(cat, persistent));
+    }
+
+    /**
+     * Create typed handle of the category. The category must be built already and store objects of class T, otherwise
+     * the exception is thrown, thus the mismatch is found during the task initialization.
+     *
+     *     auto cat_cal = model()->handle<ExampleCategories::ExampleCal, ExampleCal>();
+     *
+     * \return category handle
+     */
+    template<auto Cat, typename T>
+        requires CategoryEnum<decltype(Cat)>
+    auto handle() -> category_handle<T>
+    {
+        const auto& cinfo = registry[get_category_index(Cat)];
+        validate<T>(cinfo, cinfo.ptr);
+        return category_handle<T>(&cinfo.ptr);
+    }
+
+    /**
+     * Create typed handle of the category for the sources side. The handle points to the buffer being filled by the
+     * sources, which differs from the processed one if multiple event buffers are used, see set_buffers(). The
+     * unpackers should use it instead of handle().
+     *
+     * \return category handle
+     */
+    template<auto Cat, typename T>
+        requires CategoryEnum<decltype(Cat)>
+    auto input_handle() -> category_handle<T>
+    {
+        const auto& cinfo = registry[get_category_index(Cat)];
+        validate<T>(cinfo, cinfo.input);
+        return category_handle<T>(&cinfo.input);
+    }
+
+    /**
+     * Create typed handle of the category over all events of the batch, see set_batch(). Checks are the same as for
+     * handle().
+     *
+     *     auto hits = model()->batch_handle<ExampleCategories::ExampleRaw, ExampleRaw>();
+     *
+     * \return batch handle
+     */
+    template<auto Cat, typename T>
+        requires CategoryEnum<decltype(Cat)>
+    auto batch_handle() -> category_batch<T>
+    {
+        const auto& cinfo = registry[get_category_index(Cat)];
+        validate<T>(cinfo, cinfo.ptr);
+
+        std::vector<category*> cats;
+        for (size_t buf = 0; buf < n_buffers; ++buf) {
+            cats.push_back(get_buffer(cinfo, buf));
+        }
+
+        return category_batch<T>(std::move(cats), &batch_events);
     }
 
     /**
@@ -162,20 +340,18 @@ public:
      * \param persistent set category persistent
      * \return pointer to category object
      */
-    template<typename ECategories>
+    template<CategoryEnum ECategories>
     auto set_category(ECategories cat, bool persistent = false) -> category_info&
     {
         auto pos = get_category_index(cat);
 
-        auto& cinfo = cinfovec[pos];
+        auto& cinfo = registry[pos];
         if (!cinfo.registered) {
             throw std::out_of_range(std::format("Category with id {} not registered", pos));
         }
 
         cinfo.persistent = persistent;
         cinfo.ptr = nullptr;
-        categories[pos] = cinfo.ptr;
-        cat_name[pos] = cinfo.name;
 
         return cinfo;
     }
@@ -189,23 +365,27 @@ public:
      * \param persistent set category persistent
      * \return pointer to category object
      */
-    template<class T>
+    template<CategoryEnum T>
     auto get_category(T cat, bool /*persistent*/ = true) -> category*
     {
-        auto pos = get_category_index(cat);
-        const auto& cinfo = cinfovec[pos];
-        if (!cinfo.registered) {
-            return nullptr;
-        }
-        if (cinfo.ptr) {
-            return cinfo.ptr;
-        }
+        // Unregistered entries have null pointer
         // TODO do we need to open category if not exists?
         //     category * c = 0;//openCategory(cat, persistent);
         //     if (c)
         //         return c;
+        return registry[get_category_index(cat)].ptr;
+    }
 
-        return nullptr;
+    /**
+     * Get the category filled by the sources, see input_handle().
+     *
+     * \param cat category ID
+     * \return pointer to category object
+     */
+    template<CategoryEnum T>
+    auto get_input_category(T cat) -> category*
+    {
+        return registry[get_category_index(cat)].input;
     }
 
     template<typename... Args>
@@ -222,37 +402,343 @@ public:
     }
 
     /**
-     * Clear all categories.
+     * Enable the recycling mode of the category in all event buffers, see category::set_recycling(). Can be called
+     * before or after the category is built.
+     *
+     * \param cat category ID
+     * \param enable enable recycling
      */
-    auto clear() -> void
+    template<CategoryEnum ECategories>
+    auto set_recycling(ECategories cat, bool enable = true) -> void
+    {
+        auto& cinfo = registry[get_category_index(cat)];
+        cinfo.recycling = enable;
+        for (size_t buf = 0; cinfo.obj and buf < n_buffers; ++buf) {
+            get_buffer(cinfo, buf)->set_recycling(enable);
+        }
+    }
+
+    /**
+     * Enable parallel clear() and compress(). The categories are distributed over a thread pool, the calling thread
+     * takes part as well. Events with less filled objects than the threshold in total are processed serially, since
+     * waking up the workers costs more than clearing few objects.
+     *
+     * \param n_threads total number of threads, 1 or less disables the parallel mode
+     * \param min_objects smallest number of objects to process in parallel
+     */
+    auto set_parallel(size_t n_threads, size_t min_objects = default_parallel_threshold) -> void
+    {
+        pool = n_threads > 1 ? std::make_unique<utils::thread_pool>(n_threads - 1) : nullptr;
+        parallel_threshold = min_objects;
+    }
+
+    /**
+     * Set number of event buffers, each buffer is a complete set of categories. With more than one buffer the sources
+     * can fill next event into one buffer, see fill_buffer(), while the tasks process the current event in another
+     * buffer, see use_buffer(). Tasks and unpackers must access categories via handles then, since the raw category
+     * pointers do not follow the buffer switch. Must be called before any category is built.
+     *
+     * \param n number of buffers, from 1 to max_buffers
+     */
+    auto set_buffers(size_t n) -> void
+    {
+        if (!built.empty()) {
+            throw std::logic_error("Event buffers must be set before categories are built");
+        }
+
+        if (n == 0 or n > max_buffers) {
+            throw std::out_of_range(std::format("Number of event buffers must be from 1 to {}", max_buffers));
+        }
+
+        n_buffers = n;
+    }
+
+    /// Number of event buffers
+    /// \return buffers
+    auto get_buffers() const -> size_t { return n_buffers; }
+
+    /**
+     * Enable the batch mode, the model holds up to n events at once, one per event buffer. The sources fill the events
+     * of the batch one by one, see fill_buffer(), then each task is called once for the batch, see
+     * task::execute_batch(), and the categories of all events are compressed and cleared in a single call. Only the
+     * compress, clear and the thread pool dispatch are amortised over the batch. Each event is a separate category
+     * object, there is no storage contiguous across the events, and the default task::execute_batch() runs the task
+     * event by event. Must be called before any category is built.
+     *
+     * Each event of the batch holds a full copy of each category. The dense categories preallocate two pointers per
+     * cell of the declared volume, the sparse ones nothing proportional to it, thus the sparse storage is recommended.
+     *
+     * \param n number of events in the batch, from 1 to max_buffers
+     * \param max_memory limit of the memory preallocated by the dense categories of all events of the batch, in bytes
+     * \throw std::length_error if the registered categories exceed max_memory, the categories registered later are
+     *        checked when they are built
+     */
+    auto set_batch(size_t n, size_t max_memory = default_batch_memory) -> void
+    {
+        size_t per_event {0};
+        for (auto pos : registered) {
+            per_event += preallocation(registry[pos]);
+        }
+        check_batch_memory(n, per_event, max_memory);
+
+        set_buffers(n);
+        batch_size = n;
+        batch_memory = max_memory;
+    }
+
+    /// Maximal number of events in the batch, 1 if batch mode is disabled
+    /// \return batch size
+    auto get_batch() const -> size_t { return batch_size; }
+
+    /**
+     * Set number of events filled in the current batch, the last batch of the input may be incomplete.
+     *
+     * \param n number of events
+     */
+    auto set_batch_events(size_t n) -> void
+    {
+        if (n > n_buffers) {
+            throw std::out_of_range(std::format("Batch of {} events exceeds {} buffers", n, n_buffers));
+        }
+
+        batch_events = n;
+    }
+
+    /// Number of events filled in the current batch
+    /// \return number of events
+    auto get_batch_events() const -> size_t { return batch_events; }
+
+    /**
+     * Select buffer processed by the tasks.
+     *
+     * \param buf buffer index
+     */
+    auto use_buffer(size_t buf) -> void
+    {
+        active_buffer = buf;
+        for (auto pos : built) {
+            registry[pos].ptr = get_buffer(owner_info(pos), buf);
+        }
+    }
+
+    /**
+     * Select buffer filled by the sources. May be called from another thread than use_buffer() for a different buffer.
+     *
+     * \param buf buffer index
+     */
+    auto fill_buffer(size_t buf) -> void
     {
-        for (auto& element : categories) {
-            element.second->clear();
+        input_buffer = buf;
+        for (auto pos : built) {
+            registry[pos].input = get_buffer(registry[pos], buf);
         }
     }
 
     /**
-     * Fills the current event into the tree.
+     * Select buffer written to the output, the output branches point at category_info::output. May be called from
+     * another thread than use_buffer() for a different buffer, thus the output can be written while the tasks
+     * process next event.
      *
-     * \return status of Fill() method
+     * \param buf buffer index
+     */
+    auto write_buffer(size_t buf) -> void
+    {
+        output_buffer = buf;
+        for (auto pos : built) {
+            registry[pos].output = get_buffer(registry[pos], buf);
+        }
+    }
+
+    /**
+     * Clear the categories filled in the current event, in order of category IDs. Categories without any object are
+     * not visited at all.
+     */
+    auto clear() -> void
+    {
+        for_each_touched(active_buffer, active_buffer + 1, [](category* cat) { cat->clear(); });
+        touched[active_buffer].clear();
+    }
+
+    /**
+     * Clear all event buffers at once and reset the number of events in the batch.
+     */
+    auto clear_batch() -> void
+    {
+        for_each_touched(0, n_buffers, [](category* cat) { cat->clear(); });
+        for (size_t buf = 0; buf < n_buffers; ++buf) {
+            touched[buf].clear();
+        }
+        batch_events = 0;
+    }
+
+    /**
+     * Clear the buffer filled by the sources, serially, in the calling thread. Same as clear() with single buffer.
+     */
+    auto clear_input() -> void
+    {
+        auto& list = touched[input_buffer];
+        for (auto pos : list) {
+            get_buffer(registry[pos], input_buffer)->clear();
+        }
+        list.clear();
+    }
+
+    /**
+     * Compress the categories filled in the current event. Empty categories stay uncompressed, which is equivalent for
+     * the stored content, and compress on the first indexed access if any.
      */
     auto compress() -> void
     {
-        // clear the current event data
-        for (auto& element : categories) {
-            element.second->compress();
+        for_each_touched(active_buffer, active_buffer + 1, [](category* cat) { cat->compress(); });
+        record_stats(1);
+    }
+
+    /**
+     * Compress the categories filled in all events of the current batch at once.
+     */
+    auto compress_batch() -> void
+    {
+        for_each_touched(0, batch_events, [](category* cat) { cat->compress(); });
+        record_stats(batch_events);
+    }
+
+    /**
+     * Compress the categories filled in the buffer, serially in the calling thread, without statistics. Used by the
+     * workers of the parallel event loop, each buffer is processed by a single thread at a time.
+     *
+     * \param buf buffer index
+     */
+    auto compress_buffer(size_t buf) -> void
+    {
+        auto& list = touched[buf];
+        std::ranges::sort(list);
+        list.erase(std::ranges::unique(list).begin(), list.end());
+        for (auto pos : list) {
+            get_buffer(registry[pos], buf)->compress();
+        }
+    }
+
+    /**
+     * Add the event in the buffer compressed with compress_buffer() to the occupancy statistics.
+     *
+     * \param buf buffer index
+     */
+    auto record_buffer(size_t buf) -> void
+    {
+        ++compressed_events;
+        for (auto pos : touched[buf]) {
+            auto& stats = registry[pos].stats;
+            const auto filled = get_buffer(registry[pos], buf)->size();
+            stats.filled_sum += filled;
+            stats.filled_max = std::max(stats.filled_max, filled);
+        }
+    }
+
+    /**
+     * Create a view of this manager for a worker of the parallel event loop. The view has the same categories, but
+     * selects the processed buffer with its own use_buffer(), thus handles created from the view follow the buffer of
+     * the worker. The categories must be already built, build_category() on the view returns the existing ones. This
+     * manager must outlive the view.
+     *
+     * \return view manager
+     */
+    auto make_view() -> std::unique_ptr<category_manager>
+    {
+        auto view = std::make_unique<category_manager>();
+        view->owner = this;
+        view->n_buffers = n_buffers;
+        view->registered = registered;
+        view->built = built;
+
+        for (auto pos : registered) {
+            const auto& cinfo = registry[pos];
+            auto& vinfo = view->registry[pos];
+            vinfo.registered = cinfo.registered;
+            vinfo.persistent = cinfo.persistent;
+            vinfo.cat_id = cinfo.cat_id;
+            vinfo.name = cinfo.name;
+            vinfo.simulation = cinfo.simulation;
+            vinfo.sizes = cinfo.sizes;
+            vinfo.dim = cinfo.dim;
+            vinfo.tclass = cinfo.tclass;
+            vinfo.copy_objects = cinfo.copy_objects;
+            vinfo.mode = cinfo.mode;
+            vinfo.recycling = cinfo.recycling;
+        }
+
+        view->use_buffer(0);
+        return view;
+    }
+
+    /**
+     * Occupancy statistics of the category, collected at each compress() or compress_batch().
+     *
+     * \param cat category ID
+     * \return statistics
+     */
+    template<CategoryEnum ECategories>
+    auto get_stats(ECategories cat) const -> category_stats
+    {
+        auto stats = registry[get_category_index(cat)].stats;
+        stats.events = compressed_events - stats.first_event;
+        return stats;
+    }
+
+    /**
+     * Memory held by the category, summed over all event buffers. Walks over the objects arrays, thus meant for
+     * reporting, not for use at each event.
+     *
+     * \param cat category ID
+     * \return memory usage
+     */
+    template<CategoryEnum ECategories>
+    auto get_memory(ECategories cat) const -> category_memory
+    {
+        return memory_of(registry[get_category_index(cat)]);
+    }
+
+    /**
+     * Print occupancy and memory usage of all built categories. The occupancy relative to the declared volume tells
+     * which categories are declared much larger than needed.
+     */
+    auto print_stats() const -> void
+    {
+        constexpr double kilo = 1024.;
+
+        spdlog::info("Categories statistics after {} events:", compressed_events);
+        for (auto pos : built) {
+            const auto& cinfo = registry[pos];
+            auto stats = cinfo.stats;
+            stats.events = compressed_events - stats.first_event;
+            const auto mem = memory_of(cinfo);
+            const auto volume = cinfo.obj->get_data_size();
+
+            spdlog::info("  {:<20s} volume {:>8d}  filled mean {:>8.2f} max {:>6d} ({:5.1f}%)  "
+                         "memory [kB] prealloc {:>9.1f} current {:>9.1f} peak {:>9.1f}",
+                         cinfo.name,
+                         volume,
+                         stats.mean_filled(),
+                         stats.filled_max,
+                         volume ? 100. * static_cast<double>(stats.filled_max) / static_cast<double>(volume) : 0.,
+                         static_cast<double>(mem.preallocated) / kilo,
+                         static_cast<double>(mem.current()) / kilo,
+                         static_cast<double>(mem.peak()) / kilo);
         }
     }
 
+    /// IDs of the categories filled since last clear(), sorted after clear() or compress() only
+    /// \return touched categories
+    auto get_touched() const -> std::span<const uint8_t> { return touched[active_buffer]; }
+
     /**
      * Print info about the categories.
      */
     auto print_registered() const -> void
     {
-        spdlog::info("There are {} registered categories:", cinfovec.size());
+        spdlog::info("There are {} registered categories:", registered.size());
         std::print("  -> ");
-        for (const auto& element : cinfovec) {
-            std::print("  {}", element.second);
+        for (auto pos : registered) {
+            std::print("  {}", registry[pos]);
         }
         std::print("\n");
     }
@@ -262,16 +748,16 @@ public:
      */
     auto print() const -> void
     {
-        spdlog::info("There are {} categories in the output tree", categories.size());
-        for (const auto& element : categories) {
-            element.second->print();
+        spdlog::info("There are {} categories in the output tree", built.size());
+        for (auto pos : built) {
+            registry[pos].ptr->print();
         }
     }
 
     auto build_from_model(const std::function<void(category_info&)>& func) -> void
     {
-        for (auto& [key, element] : cinfovec) {
-            func(element);
+        for (auto pos : registered) {
+            func(registry[pos]);
         }
     }
 
@@ -279,15 +765,209 @@ private:
     /// Maps category kind and simulation flag into index.
     /// \param cat category kind
     /// \return linearised index of the category
+    template<CategoryEnum T>
+    static constexpr auto get_category_index(T cat) -> uint8_t
+    {
+        return static_cast<uint8_t>(cat);
+    }
+
+    /// Category object of given buffer
+    static auto get_buffer(const category_info& cinfo, size_t buf) -> category*
+    {
+        return buf == 0 ? cinfo.obj.get() : cinfo.buffers[buf - 1].get();
+    }
+
+    /// Entry owning the category objects, of the owner manager in case of a view
+    auto owner_info(uint8_t pos) const -> const category_info&
+    {
+        return owner ? owner->registry[pos] : registry[pos];
+    }
+
+    /// Common part of the runtime and model registration, the name and shape must be already set
+    auto fill_info(category_info& cinfo, uint8_t pos, bool simulation, storage_mode mode) -> void
+    {
+        cinfo.registered = true;
+        cinfo.cat_id = pos;
+        cinfo.simulation = simulation;
+        cinfo.mode = mode;
+        insert_sorted(registered, pos);
+        spdlog::info("    -> Category {} registered with sizes: {}  sim: {} in {}",
+                     cinfo.name,
+                     cinfo.shape(),
+                     simulation,
+                     (void*)this);
+    }
+
+    /// Build category objects of all buffers
+    /// \param pos category index
+    /// \param tclass class of stored objects
+    /// \param persistent set category persistent
+    /// \return category object of the active buffer
+    auto build_category_class(uint8_t pos, TClass* tclass, bool persistent) -> category*
+    {
+        auto& cinfo = registry[pos];
+        if (cinfo.obj or (owner and cinfo.ptr)) {
+            return cinfo.ptr;
+        }
+
+        if (!cinfo.registered) {
+            throw std::out_of_range(std::format("Category with id {} not registered", pos));
+        }
+
+        if (owner) {
+            throw std::logic_error(std::format("Category {} must be built before the view is created", cinfo.name));
+        }
+
+        if (batch_size > 1) {
+            size_t per_event {preallocation(cinfo)};
+            for (auto built_pos : built) {
+                per_event += preallocation(registry[built_pos]);
+            }
+            check_batch_memory(batch_size, per_event, batch_memory);
+        }
+
+        cinfo.persistent = persistent;
+        cinfo.obj = std::make_unique<category>(tclass, cinfo.shape(), cinfo.simulation, cinfo.mode);
+        cinfo.obj->set_touch_list(&touched[0], pos);
+        cinfo.obj->set_recycling(cinfo.recycling);
+        for (size_t buf = 1; buf < n_buffers; ++buf) {
+            cinfo.buffers.push_back(std::make_unique<category>(tclass, cinfo.shape(), cinfo.simulation, cinfo.mode));
+            cinfo.buffers.back()->set_touch_list(&touched[buf], pos);
+            cinfo.buffers.back()->set_recycling(cinfo.recycling);
+        }
+        cinfo.ptr = get_buffer(cinfo, active_buffer);
+        cinfo.input = get_buffer(cinfo, input_buffer);
+        cinfo.output = get_buffer(cinfo, output_buffer);
+        cinfo.stats.first_event = compressed_events;
+        insert_sorted(built, pos);
+        for (auto& list : touched) {
+            list.reserve(built.size());
+        }
+
+        return cinfo.ptr;
+    }
+
+    /// Memory preallocated by a dense category in one event, the pointer arrays of the declared volume
+    /// \return size in bytes, 0 for the sparse storage
+    static auto preallocation(const category_info& cinfo) -> size_t
+    {
+        if (cinfo.mode == storage_mode::sparse) {
+            return 0;
+        }
+
+        const auto shape = cinfo.shape();
+        return std::accumulate(shape.begin(), shape.end(), size_t {1}, std::multiplies {}) * 2 * sizeof(TObject*);
+    }
+
+    /// Throw if the batch of n events does not fit in the memory limit, see set_batch()
+    static auto check_batch_memory(size_t n, size_t per_event, size_t max_memory) -> void
+    {
+        if (n > 1 and n * per_event > max_memory) {
+            throw std::length_error(std::format("Batch of {} events needs {} bytes for the categories preallocation, "
+                                                "the limit is {} bytes, see category_manager::set_batch()",
+                                                n,
+                                                n * per_event,
+                                                max_memory));
+        }
+    }
+
+    /// Memory of the category summed over the buffers
+    auto memory_of(const category_info& cinfo) const -> category_memory
+    {
+        category_memory mem;
+        for (size_t buf = 0; cinfo.obj and buf < n_buffers; ++buf) {
+            mem += get_buffer(cinfo, buf)->memory_usage();
+        }
+        return mem;
+    }
+
+    /// Add the categories compressed by last maintenance call to the statistics
+    /// \param n_events number of compressed events
+    auto record_stats(size_t n_events) -> void
+    {
+        compressed_events += n_events;
+        for (auto [pos, cat] : jobs) {
+            auto& stats = registry[pos].stats;
+            const auto filled = cat->size();
+            stats.filled_sum += filled;
+            stats.filled_max = std::max(stats.filled_max, filled);
+        }
+    }
+
+    /// Check that the category is built and stores objects of class T, before a handle is created.
     template<typename T>
-    static constexpr auto get_category_index(T cat) -> std::underlying_type_t<T>
+    static auto validate(const category_info& cinfo, const category* cat) -> void
+    {
+        if (cat == nullptr) {
+            throw std::out_of_range(std::format("Category {} not built", cinfo.cat_id));
+        }
+
+        if (!cat->template stores<T>()) {
+            throw std::runtime_error(std::format("Category {} does not store objects of class {}",
+                                                 cinfo.name,
+                                                 TClass::GetClass<T>()->GetName()));
+        }
+    }
+
+    /// Apply func to the categories filled in the buffers [first, last), in parallel if enabled and worth it.
+    template<typename F>
+    auto for_each_touched(size_t first, size_t last, F&& func) -> void
+    {
+        jobs.clear();
+        size_t objects {0};
+
+        for (auto buf = first; buf < last; ++buf) {
+            auto& list = touched[buf];
+            if (list.size() > 1) {
+                // A category cleared directly, not by the manager, reports itself again when refilled.
+                std::ranges::sort(list);
+                list.erase(std::ranges::unique(list).begin(), list.end());
+            }
+
+            for (auto pos : list) {
+                auto* cat = get_buffer(registry[pos], buf);
+                if (pool) {
+                    objects += cat->size();
+                }
+                jobs.emplace_back(pos, cat);
+            }
+        }
+
+        if (pool and jobs.size() > 1 and objects >= parallel_threshold) {
+            pool->parallel_for(jobs.size(), [&](size_t idx) { func(jobs[idx].second); });
+            return;
+        }
+
+        for (const auto& job : jobs) {
+            func(job.second);
+        }
+    }
+
+    /// Insert category ID keeping the list sorted, happens only during setup.
+    static auto insert_sorted(std::vector<uint8_t>& ids, uint8_t pos) -> void
     {
-        return static_cast<typename std::underlying_type<T>::type>(cat);
+        auto iter = std::ranges::lower_bound(ids, pos);
+        if (iter == ids.end() or *iter != pos) {
+            ids.insert(iter, pos);
+        }
     }
 
-    std::map<uint8_t, std::string> cat_name;   ///< category type
-    std::map<size_t, category_info> cinfovec;  ///< Category info array
-    std::map<uint16_t, category*> categories;  ///< Map of categories
+    std::array<category_info, max_categories> registry;      ///< Category info indexed by category ID
+    std::vector<uint8_t> registered;                         ///< IDs of registered categories, sorted
+    std::vector<uint8_t> built;                              ///< IDs of categories built by this manager, sorted
+    std::array<std::vector<uint8_t>, max_buffers> touched;   ///< IDs of categories filled in each buffer
+    size_t n_buffers {1};                                    ///< number of event buffers
+    size_t active_buffer {0};                                ///< buffer processed by the tasks
+    size_t input_buffer {0};                                 ///< buffer filled by the sources
+    size_t output_buffer {0};                                ///< buffer written to the output
+    size_t batch_size {1};                                   ///< maximal number of events in the batch
+    size_t batch_events {0};                                 ///< number of events in the current batch
+    size_t batch_memory {default_batch_memory};              ///< limit of the preallocated memory of the batch
+    std::vector<std::pair<uint8_t, category*>> jobs;         ///< categories visited by clear or compress
+    size_t compressed_events {0};                            ///< number of events compressed so far
+    std::unique_ptr<utils::thread_pool> pool;                ///< workers of parallel mode
+    size_t parallel_threshold {default_parallel_threshold};  ///< smallest event processed in parallel
+    category_manager* owner {nullptr};                       ///< manager owning the categories, set for views
 
     friend struct std::formatter<spark::category_info>;
 };
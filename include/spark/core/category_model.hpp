@@ -0,0 +1,194 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#pragma once
+
+#include "spark/core/category.hpp"
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <TClass.h>
+
+namespace spark
+{
+
+/// Category IDs are enums of one byte underlying type, their values index the registry directly.
+template<typename T>
+concept CategoryEnum = std::is_enum_v<T> && sizeof(std::underlying_type_t<T>) == 1;
+
+/// Maximal number of category dimensions
+inline constexpr size_t max_category_dim = 8;
+
+/**
+ * Copy the objects of the category in order of their positions into std::vector<T> pointed by out. Used by the outputs
+ * which store the objects by value, e.g. writer::ntuple.
+ *
+ * \param cat category storing objects of T
+ * \param out pointer to std::vector<T>, its content is replaced
+ */
+template<typename T>
+auto copy_category_objects(category* cat, void* out) -> void
+{
+    auto& objects = *static_cast<std::vector<T>*>(out);
+    objects.clear();
+    objects.reserve(cat->size());
+    for (size_t idx = 0; idx < cat->size(); ++idx) {
+        objects.push_back(*cat->get_object_unchecked<T>(types::size_t2int(idx)));
+    }
+}
+
+/// Type-erased copy_category_objects() of the class stored in the category
+using copy_objects_fn = auto (*)(category*, void*) -> void;
+
+/// Copy function of the class, nullptr if the objects cannot be copied
+/// \return function pointer
+template<typename T>
+constexpr auto objects_copier() -> copy_objects_fn
+{
+    if constexpr (std::is_copy_constructible_v<T>) {
+        return &copy_category_objects<T>;
+    } else {
+        return nullptr;
+    }
+}
+
+/**
+ * \class category_def
+ * \ingroup lib_core
+ *
+ * Compile-time description of a single category, created with define_category().
+ */
+template<CategoryEnum ECategories>
+struct category_def
+{
+    ECategories cat {};                             ///< category ID
+    std::string_view name;                          ///< category name, must refer to static storage
+    auto (*get_class)() -> TClass* {nullptr};       ///< class of stored objects
+    copy_objects_fn copy_objects {nullptr};         ///< copy of the objects by value, see copy_category_objects()
+    std::array<size_t, max_category_dim> sizes {};  ///< dimensions sizes
+    size_t dim {0};                                 ///< number of dimensions
+    bool persistent {true};                         ///< category is written to the output
+    bool simulation {false};                        ///< simulation run
+    storage_mode mode {storage_mode::dense};        ///< objects storage
+
+    /// Sizes of the used dimensions
+    /// \return sizes
+    constexpr auto shape() const -> std::span<const size_t> { return {sizes.data(), dim}; }
+};
+
+/**
+ * Describe category storing objects of class T.
+ *
+ * \param cat category ID
+ * \param name category name
+ * \param sizes sizes of dimension
+ * \param persistent category is written to the output
+ * \param simulation simulation run
+ * \param mode objects storage
+ * \return category description
+ */
+template<typename T, CategoryEnum ECategories>
+consteval auto define_category(ECategories cat,
+                               std::string_view name,
+                               std::initializer_list<size_t> sizes,
+                               bool persistent = true,
+                               bool simulation = false,
+                               storage_mode mode = storage_mode::dense) -> category_def<ECategories>
+{
+    if (sizes.size() == 0 or sizes.size() > max_category_dim) {
+        throw "Category dimension must be between 1 and max_category_dim";
+    }
+
+    category_def<ECategories> def {
+        .cat = cat,
+        .name = name,
+        .get_class = +[]() -> TClass* { return TClass::GetClass<T>(); },
+        .copy_objects = objects_copier<T>(),
+        .dim = sizes.size(),
+        .persistent = persistent,
+        .simulation = simulation,
+        .mode = mode,
+    };
+
+    size_t i = 0;
+    for (auto size : sizes) {
+        def.sizes[i++] = size;
+    }
+
+    return def;
+}
+
+/**
+ * \class category_model
+ * \ingroup lib_core
+ *
+ * Table of all categories of the analysis, created with make_model(). The table is checked at compile time, thus
+ * duplicated IDs or names and invalid shapes do not compile. Register it with category_manager::register_model() or
+ * sparksys::use_model().
+ *
+ *     inline constexpr auto example_model = spark::make_model(
+ *         spark::define_category<ExampleRaw>(ExampleCategories::ExampleRaw, "ExampleRaw", {64}),
+ *         spark::define_category<ExampleCal>(ExampleCategories::ExampleCal, "ExampleCal", {64}));
+ */
+template<CategoryEnum ECategories, size_t N>
+struct category_model
+{
+    using enum_type = ECategories;
+
+    std::array<category_def<ECategories>, N> defs;  ///< categories descriptions
+
+    constexpr auto begin() const { return defs.begin(); }
+    constexpr auto end() const { return defs.end(); }
+    constexpr auto size() const -> size_t { return N; }
+};
+
+/**
+ * Create model from the categories descriptions and verify it.
+ *
+ * \param defs categories descriptions
+ * \return model
+ */
+template<CategoryEnum ECategories, typename... Defs>
+    requires(std::is_same_v<Defs, category_def<ECategories>> && ...)
+consteval auto make_model(category_def<ECategories> first, Defs... defs)
+    -> category_model<ECategories, sizeof...(Defs) + 1>
+{
+    auto model = category_model<ECategories, sizeof...(Defs) + 1> {{first, defs...}};
+
+    for (size_t i = 0; i < model.size(); ++i) {
+        const auto& def = model.defs[i];
+        if (def.name.empty()) {
+            throw "Category name must not be empty";
+        }
+
+        for (size_t d = 0; d < def.dim; ++d) {
+            if (def.sizes[d] == 0) {
+                throw "Category dimension size must not be zero";
+            }
+        }
+
+        for (size_t j = 0; j < i; ++j) {
+            if (model.defs[j].cat == def.cat) {
+                throw "Category ID defined twice";
+            }
+            if (model.defs[j].name == def.name) {
+                throw "Category name defined twice";
+            }
+        }
+    }
+
+    return model;
+}
+
+}  // namespace spark
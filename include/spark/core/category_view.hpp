@@ -0,0 +1,176 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <utility>
+
+#include <TClonesArray.h>
+#include <TObject.h>
+
+namespace spark
+{
+
+/**
+ * \class category_view
+ * \ingroup lib_core
+ *
+ * Typed random-access range over the compressed entries of a category.
+ *
+ * Each element is a pair of the entry locator and a reference to the stored object. The object type is verified once
+ * when the view is created by category::view<T>(), so no RTTI is involved in the element access. The view and its
+ * iterators are valid until the category is cleared or a next view of the same category is created.
+ *
+ * The view models std::ranges::random_access_range. The elements are proxies, not references, thus the legacy iterator
+ * category is input only. The std::execution algorithms accept the view, but may run sequentially.
+ */
+template<typename T>
+class category_view
+{
+public:
+    using locator_type = std::span<const size_t>;
+    using element_type = std::pair<locator_type, T&>;
+
+    class iterator
+    {
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        /// The reference is a prvalue pair, thus a legacy iterator is only an input iterator
+        using iterator_category = std::input_iterator_tag;
+        using value_type = element_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = element_type;
+        using pointer = void;
+
+        iterator() = default;
+
+        iterator(TClonesArray* array, const size_t* locs, size_t dims, difference_type idx)
+            : data {array}
+            , locators {locs}
+            , dim {dims}
+            , index {idx}
+        {
+        }
+
+        auto operator*() const -> reference { return at(index); }
+
+        auto operator[](difference_type off) const -> reference { return at(index + off); }
+
+        auto operator++() -> iterator&
+        {
+            ++index;
+            return *this;
+        }
+
+        auto operator++(int) -> iterator
+        {
+            auto tmp = *this;
+            ++index;
+            return tmp;
+        }
+
+        auto operator--() -> iterator&
+        {
+            --index;
+            return *this;
+        }
+
+        auto operator--(int) -> iterator
+        {
+            auto tmp = *this;
+            --index;
+            return tmp;
+        }
+
+        auto operator+=(difference_type off) -> iterator&
+        {
+            index += off;
+            return *this;
+        }
+
+        auto operator-=(difference_type off) -> iterator&
+        {
+            index -= off;
+            return *this;
+        }
+
+        friend auto operator+(iterator iter, difference_type off) -> iterator { return iter += off; }
+
+        friend auto operator+(difference_type off, iterator iter) -> iterator { return iter += off; }
+
+        friend auto operator-(iterator iter, difference_type off) -> iterator { return iter -= off; }
+
+        friend auto operator-(const iterator& lhs, const iterator& rhs) -> difference_type
+        {
+            return lhs.index - rhs.index;
+        }
+
+        friend auto operator==(const iterator& lhs, const iterator& rhs) -> bool { return lhs.index == rhs.index; }
+
+        friend auto operator<=>(const iterator& lhs, const iterator& rhs) -> std::strong_ordering
+        {
+            return lhs.index <=> rhs.index;
+        }
+
+    private:
+        auto at(difference_type idx) const -> reference
+        {
+            return {locator_type(locators + (static_cast<size_t>(idx) * dim), dim),
+                    *static_cast<T*>(data->UncheckedAt(static_cast<int>(idx)))};
+        }
+
+        TClonesArray* data {nullptr};
+        const size_t* locators {nullptr};
+        size_t dim {0};
+        difference_type index {0};
+    };
+
+    category_view() = default;
+
+    /**
+     * Constructor
+     *
+     * \param array array of compressed objects
+     * \param locs flattened locators of the objects, dim values per object
+     * \param dims category dimension
+     */
+    category_view(TClonesArray* array, std::span<const size_t> locs, size_t dims)
+        : data {array}
+        , locators {locs}
+        , dim {dims}
+        , count {dims ? locs.size() / dims : 0}
+    {
+    }
+
+    auto operator[](size_t idx) const -> element_type { return begin()[static_cast<std::ptrdiff_t>(idx)]; }
+
+    auto begin() const -> iterator { return {data, locators.data(), dim, 0}; }
+
+    auto end() const -> iterator { return {data, locators.data(), dim, static_cast<std::ptrdiff_t>(count)}; }
+
+    auto size() const -> size_t { return count; }
+
+    auto empty() const -> bool { return count == 0; }
+
+private:
+    TClonesArray* data {nullptr};       ///< compressed objects
+    std::span<const size_t> locators;  ///< flattened locators
+    size_t dim {0};                    ///< category dimension
+    size_t count {0};                  ///< number of entries
+};
+
+}  // namespace spark
+
+/// The iterators do not refer to the view object, thus they remain valid after the view is destroyed.
+template<typename T>
+inline constexpr bool std::ranges::enable_borrowed_range<spark::category_view<T>> = true;
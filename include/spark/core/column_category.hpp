@@ -0,0 +1,284 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#pragma once
+
+#include "spark/spark_export.hpp"
+
+#include "spark/core/category.hpp"
+#include "spark/core/category_batch.hpp"
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <TTree.h>
+
+#include <fmt/format.h>
+
+namespace spark
+{
+
+/**
+ * Type-erased interface of the columnar outputs used by the writer, see writer::tree::add_columns().
+ */
+class SPARK_EXPORT column_store
+{
+public:
+    column_store() = default;
+
+    column_store(const column_store&) = delete;
+    column_store(column_store&&) = delete;
+
+    auto operator=(const column_store&) -> column_store& = delete;
+    auto operator=(column_store&&) -> column_store& = delete;
+
+    virtual ~column_store() = default;
+
+    /// Create one branch per column in the tree
+    /// \param tree output tree
+    virtual auto make_branches(TTree* tree) -> void = 0;
+
+    /// Remove all entries
+    virtual auto clear() -> void = 0;
+
+    /// Number of entries
+    /// \return size
+    virtual auto size() const -> size_t = 0;
+};
+
+/**
+ * \class column_category
+ * \ingroup lib_core
+ *
+ * Structure-of-arrays export adapter of the selected data members of T.
+ *
+ * Each member given as template argument is kept in its own contiguous array, together with the column of linear
+ * positions of the entries. It is not the storage of the category, the objects stay in the category and the columns
+ * are a separate copy: filled directly with emplace(), or copied from a compressed category with gather() and back
+ * with scatter(). Each copy costs a pass over the objects, thus the adapter does not reduce the memory traffic of the
+ * event processing. It serves to write the members as separate branches "name.member", see
+ * writer::tree::add_columns(), which is supported by the serial event loop only.
+ *
+ *     auto cols = spark::column_category<ExampleRaw, &ExampleRaw::toa, &ExampleRaw::tot>("ExampleRawCols",
+ *                                                                                    {"toa", "tot"});
+ *     cols.gather(*cat_raw);
+ *     for (auto& tot : cols.column<&ExampleRaw::tot>()) { ... }
+ */
+template<typename T, auto... Members>
+class column_category : public column_store
+{
+public:
+    static constexpr size_t n_columns = sizeof...(Members);
+
+    static_assert(n_columns > 0, "At least one column is required");
+    static_assert((std::is_member_object_pointer_v<decltype(Members)> && ...), "Columns must be data members");
+    static_assert((!std::is_same_v<std::remove_cvref_t<decltype(std::declval<T&>().*Members)>, bool> && ...),
+                  "Boolean columns are not contiguous, use integer type instead");
+
+    template<auto Member>
+    using member_t = std::remove_cvref_t<decltype(std::declval<T&>().*Member)>;
+
+    /**
+     * Constructor
+     *
+     * \param name name of the columns group, used as branch prefix
+     * \param member_names names of the columns
+     */
+    column_category(std::string name, std::array<std::string, n_columns> member_names)
+        : cols_name {std::move(name)}
+        , names {std::move(member_names)}
+    {
+    }
+
+    /**
+     * Append entry at given position.
+     *
+     * \param pos linear position of the entry
+     * \param values values of the columns
+     * \return index of the entry
+     */
+    auto emplace(size_t pos, member_t<Members>... values) -> size_t
+    {
+        positions.push_back(pos);
+        push_values(std::index_sequence_for<decltype(Members)...> {}, values...);
+        return positions.size() - 1;
+    }
+
+    /**
+     * Fill the columns from the compressed category. Previous content is replaced.
+     *
+     * \param cat source category
+     */
+    auto gather(category& cat) -> void
+    {
+        auto cat_view = cat.view<T>();
+        const auto entries = cat_view.size();
+
+        resize(entries);
+        offsets = {0, entries};
+
+        for (size_t i = 0; i < entries; ++i) {
+            positions[i] = cat.get_position(i);
+            load(i, cat_view[i].second, std::index_sequence_for<decltype(Members)...> {});
+        }
+    }
+
+    /**
+     * Fill the columns from all events of the batch, the events follow each other in the columns. Previous content is
+     * replaced. The range of entries of each event is given by event_offsets().
+     *
+     * \param batch source batch
+     */
+    auto gather(category_batch<T>& batch) -> void
+    {
+        const auto offs = batch.offsets();
+        offsets.assign(offs.begin(), offs.end());
+
+        resize(offsets.back());
+
+        for (size_t evt = 0; evt < batch.size(); ++evt) {
+            auto* cat = batch.get(evt);
+            auto idx = offsets[evt];
+            for (auto [loc, obj] : batch.event(evt)) {
+                positions[idx] = cat->get_position(idx - offsets[evt]);
+                load(idx, obj, std::index_sequence_for<decltype(Members)...> {});
+                ++idx;
+            }
+        }
+    }
+
+    /// Index of the first entry of each event after gather() of a batch, followed by total number of entries
+    /// \return offsets
+    auto event_offsets() const -> std::span<const size_t> { return offsets; }
+
+    /**
+     * Write the columns back into the category objects at the same indexes. The category must be compressed and have
+     * the same number of entries.
+     *
+     * \param cat target category
+     */
+    auto scatter(category& cat) const -> void
+    {
+        auto cat_view = cat.view<T>();
+
+        if (cat_view.size() != size()) {
+            throw std::runtime_error(fmt::format(
+                "Columns {} size {} does not match category size {}", cols_name, size(), cat_view.size()));
+        }
+
+        for (size_t i = 0; i < size(); ++i) {
+            store(i, cat_view[i].second, std::index_sequence_for<decltype(Members)...> {});
+        }
+    }
+
+    /**
+     * Contiguous array of the given member values.
+     *
+     * \return column
+     */
+    template<auto Member>
+    auto column() -> std::span<member_t<Member>>
+    {
+        return std::get<column_index<Member>()>(columns);
+    }
+
+    template<auto Member>
+    auto column() const -> std::span<const member_t<Member>>
+    {
+        return std::get<column_index<Member>()>(columns);
+    }
+
+    /// Linear positions of the entries
+    /// \return locator column
+    auto locators() const -> std::span<const size_t> { return positions; }
+
+    auto make_branches(TTree* tree) -> void override
+    {
+        tree->Branch(fmt::format("{}.pos", cols_name).c_str(), &positions);
+        make_branches_impl(tree, std::index_sequence_for<decltype(Members)...> {});
+    }
+
+    auto clear() -> void override
+    {
+        positions.clear();
+        offsets.clear();
+        std::apply([](auto&... col) { (col.clear(), ...); }, columns);
+    }
+
+    auto size() const -> size_t override { return positions.size(); }
+
+    auto get_name() const -> const std::string& { return cols_name; }
+
+private:
+    template<auto Member>
+    static consteval auto column_index() -> size_t
+    {
+        constexpr std::array<bool, n_columns> matches {is_same_member<Member, Members>()...};
+        for (size_t i = 0; i < n_columns; ++i) {
+            if (matches[i]) {
+                return i;
+            }
+        }
+        throw "Member is not stored in the columns";
+    }
+
+    template<auto A, auto B>
+    static consteval auto is_same_member() -> bool
+    {
+        if constexpr (std::is_same_v<decltype(A), decltype(B)>) {
+            return A == B;
+        } else {
+            return false;
+        }
+    }
+
+    auto resize(size_t entries) -> void
+    {
+        positions.resize(entries);
+        std::apply([&](auto&... col) { (col.resize(entries), ...); }, columns);
+    }
+
+    template<size_t... Is>
+    auto push_values(std::index_sequence<Is...> /*unused*/, member_t<Members>... values) -> void
+    {
+        (std::get<Is>(columns).push_back(values), ...);
+    }
+
+    template<size_t... Is>
+    auto load(size_t idx, const T& obj, std::index_sequence<Is...> /*unused*/) -> void
+    {
+        ((std::get<Is>(columns)[idx] = obj.*Members), ...);
+    }
+
+    template<size_t... Is>
+    auto store(size_t idx, T& obj, std::index_sequence<Is...> /*unused*/) const -> void
+    {
+        ((obj.*Members = std::get<Is>(columns)[idx]), ...);
+    }
+
+    template<size_t... Is>
+    auto make_branches_impl(TTree* tree, std::index_sequence<Is...> /*unused*/) -> void
+    {
+        (tree->Branch(fmt::format("{}.{}", cols_name, names[Is]).c_str(), &std::get<Is>(columns)), ...);
+    }
+
+    std::string cols_name;                                  ///< name of the columns group
+    std::array<std::string, n_columns> names;               ///< names of the columns
+    std::vector<size_t> positions;                          ///< locator column
+    std::vector<size_t> offsets;                            ///< first entry of each event of the gathered batch
+    std::tuple<std::vector<member_t<Members>>...> columns;  ///< data columns
+};
+
+}  // namespace spark
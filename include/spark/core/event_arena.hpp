@@ -0,0 +1,90 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#pragma once
+
+#include "spark/spark_export.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+namespace spark::details
+{
+
+/**
+ * Monotonic arena for the per-event payload of category objects.
+ *
+ * Objects which are constructible from std::pmr::memory_resource* receive the arena resource when created in a
+ * category, so their std::pmr containers allocate from it. Deallocation is a no-op, and reset() drops all allocations
+ * at once when the category is cleared. The arena owns a single buffer. If an event does not fit in it, the missing
+ * memory is taken from the heap and at the next reset() the buffer grows to the observed high-water mark, so in the
+ * steady state the event loop does not call malloc at all. The owner must destroy the objects using the arena before
+ * reset(), see category::arena().
+ */
+class SPARK_EXPORT event_arena
+{
+public:
+    static constexpr size_t default_size = 64 * 1024;
+
+    /**
+     * Constructor
+     *
+     * \param initial_size initial size of the buffer in bytes
+     */
+    explicit event_arena(size_t initial_size = default_size);
+
+    event_arena(const event_arena&) = delete;
+    event_arena(event_arena&&) = delete;
+
+    auto operator=(const event_arena&) -> event_arena& = delete;
+    auto operator=(event_arena&&) -> event_arena& = delete;
+
+    ~event_arena() = default;
+
+    /// Memory resource to allocate the payload from
+    /// \return resource
+    auto resource() -> std::pmr::memory_resource* { return &*pool; }
+
+    /// Release all allocations. If the buffer was exceeded since the last reset, it grows to fit the whole event.
+    auto reset() -> void;
+
+    /// Size of the buffer
+    /// \return size in bytes
+    auto capacity() const -> size_t { return buffer_size; }
+
+    /// Number of heap allocations done by the arena since its creation, including the buffer growths
+    /// \return number of allocations
+    auto heap_allocations() const -> size_t { return upstream.allocations + growths; }
+
+private:
+    /// Forwards to the default resource and counts the bytes which did not fit into the buffer
+    class counting_resource : public std::pmr::memory_resource
+    {
+    public:
+        size_t bytes {0};        ///< bytes allocated since last reset
+        size_t allocations {0};  ///< total number of allocations
+
+    private:
+        auto do_allocate(size_t bytes_n, size_t alignment) -> void* override;
+        auto do_deallocate(void* ptr, size_t bytes_n, size_t alignment) -> void override;
+        auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override
+        {
+            return this == &other;
+        }
+    };
+
+    std::unique_ptr<std::byte[]> buffer;                     ///< arena storage
+    size_t buffer_size {0};                                  ///< size of the storage
+    size_t growths {0};                                      ///< number of storage reallocations
+    counting_resource upstream;                              ///< overflow allocator
+    std::optional<std::pmr::monotonic_buffer_resource> pool;  ///< allocator over the storage
+};
+
+}  // namespace spark::details
@@ -0,0 +1,168 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#pragma once
+
+#include "spark/spark_export.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <Rtypes.h>
+
+namespace spark::details
+{
+
+/**
+ * Occupancy bitmap of the linearized category volume with a rank structure.
+ *
+ * Each bit corresponds to one uncompressed position of the category. Setting a bit marks the slot as filled. After
+ * build_rank() is called, rank(pos) returns number of filled slots preceding pos, which is exactly the index of the
+ * object in the compressed array. The storage is allocated once by resize() and reused for every event.
+ *
+ * The words which received any bit are remembered, so that build_rank(), collect() and clear() visit only them and
+ * their cost scales with the number of filled slots, not with the capacity.
+ *
+ * The bits are not streamed, the owner persists the filled positions and calls rebuild() after reading them.
+ */
+class SPARK_EXPORT occupancy_index
+{
+public:
+    using word_t = uint64_t;
+    static constexpr size_t word_bits = sizeof(word_t) * 8;
+
+    /**
+     * Resize the index to cover given number of positions. All bits are cleared.
+     *
+     * \param bits number of positions
+     */
+    auto resize(size_t bits) -> void
+    {
+        n_bits = bits;
+        words.assign((bits + word_bits - 1) / word_bits, 0);
+        ranks.assign(words.size(), 0);
+        touched.clear();
+        n_set = 0;
+    }
+
+    /**
+     * Mark position as filled.
+     *
+     * \param pos position
+     * \return true if position was not filled before
+     */
+    auto set(size_t pos) -> bool
+    {
+        auto& word = words[pos / word_bits];
+        const auto mask = word_t {1} << (pos % word_bits);
+        if (word & mask) {
+            return false;
+        }
+
+        if (word == 0) {
+            touched.push_back(static_cast<uint32_t>(pos / word_bits));
+        }
+        word |= mask;
+        ++n_set;
+        return true;
+    }
+
+    /**
+     * Mark all positions as filled. Positions must be in the range.
+     *
+     * \param poss positions
+     * \return number of positions which were not filled before
+     */
+    auto set(std::span<const size_t> poss) -> size_t;
+
+    /**
+     * Check whether position is filled. Positions out of the range are never filled.
+     *
+     * \param pos position
+     * \return is filled
+     */
+    auto test(size_t pos) const -> bool
+    {
+        if (pos >= n_bits) {
+            return false;
+        }
+        return (words[pos / word_bits] >> (pos % word_bits)) & word_t {1};
+    }
+
+    /**
+     * Number of filled positions preceding filled position pos. Valid only after build_rank().
+     *
+     * \param pos position
+     * \return rank of the position
+     */
+    auto rank(size_t pos) const -> size_t
+    {
+        const auto word_idx = pos / word_bits;
+        const auto mask = (word_t {1} << (pos % word_bits)) - 1;
+        return ranks[word_idx] + static_cast<size_t>(std::popcount(words[word_idx] & mask));
+    }
+
+    /**
+     * Position of the idx-th filled slot. Valid only after build_rank().
+     *
+     * \param idx index of the filled slot
+     * \return position or n_bits if not found
+     */
+    auto select(size_t idx) const -> size_t;
+
+    /**
+     * Resize the index if needed and fill it with the given positions, then build the ranks. Used to restore the bits
+     * after the positions were read from a file.
+     *
+     * \param bits number of positions
+     * \param poss filled positions
+     */
+    auto rebuild(size_t bits, std::span<const size_t> poss) -> void;
+
+    /// Compute prefix popcount over the touched words.
+    auto build_rank() -> void;
+
+    /**
+     * Write filled positions in ascending order.
+     *
+     * \param positions output array, its content is replaced
+     */
+    auto collect(std::vector<size_t>& positions) const -> void;
+
+    /// Clear all bits. Only the touched words are reset.
+    auto clear() -> void;
+
+    /// Number of filled positions
+    /// \return count
+    auto count() const -> size_t { return n_set; }
+
+    /// Number of positions covered
+    /// \return capacity
+    auto capacity() const -> size_t { return n_bits; }
+
+    /// Heap memory held by the index
+    /// \return size in bytes
+    auto memory_usage() const -> size_t
+    {
+        return (words.capacity() * sizeof(word_t)) + ((ranks.capacity() + touched.capacity()) * sizeof(uint32_t));
+    }
+
+private:
+    std::vector<word_t> words;      //! occupancy bits
+    std::vector<uint32_t> ranks;    //! number of set bits preceding each word
+    size_t n_bits {0};              ///< number of positions
+    size_t n_set {0};               ///< number of set positions
+    std::vector<uint32_t> touched;  //! words with any bit set
+
+    ClassDefNV(occupancy_index, 2)
+};
+
+}  // namespace spark::details
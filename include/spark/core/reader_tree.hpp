@@ -223,17 +223,18 @@ public:
         for (auto cat : categories) {
             auto& cat_info = model().get_category_info(cat);
             spdlog::info("Read category {:s}", cat_info.name);
+            const auto branch_name = std::string(cat_info.name);
 
-            TBranch* br = input_tree->GetBranch(Form("%s", cat_info.name.c_str()));  // FIXME add .
+            TBranch* br = input_tree->GetBranch(branch_name.c_str());  // FIXME add .
             if (!br) {
                 //         Error("setInput()","Branch not found : %s !",Form("%s.",catname.Data()));
                 //         return kFALSE;
             } else {
                 auto& cat_info = model().set_category(cat);
 
-                input_tree->SetBranchAddress(Form("%s", cat_info.name.c_str()), &cat_info.ptr);
-                input_tree->SetBranchStatus(Form("%s", cat_info.name.c_str()), 1);
-                input_tree->SetBranchStatus(Form("%s", cat_info.name.c_str()), 1);
+                input_tree->SetBranchAddress(branch_name.c_str(), &cat_info.ptr);
+                input_tree->SetBranchStatus(branch_name.c_str(), 1);
+                input_tree->SetBranchStatus(branch_name.c_str(), 1);
             }
         }
     }
@@ -10,11 +10,16 @@
 
 // #include "spark/data_struct/SCategory.hpp"
 
+#include "spark/core/category_model.hpp"
 #include "spark/external/magic_enum.hpp"
 #include "spark/utils/conversions.hpp"
 
+#include <algorithm>
+#include <array>
 #include <map>
 #include <print>
+#include <string_view>
+#include <utility>
 
 #include <Rtypes.h>
 #include <TObject.h>
@@ -47,6 +52,20 @@ struct root_file_header : public TObject
         // std::print("serialized {} bytes -> {}\n", bytes_written, serialized_categories);
     }
 
+    /**
+     * Store the categories of the model instead of all enum entries, thus only the declared categories are recorded.
+     *
+     * \param model categories model
+     */
+    template<CategoryEnum ECategories, size_t N>
+    auto serialize(const category_model<ECategories, N>& model) -> void
+    {
+        std::array<std::pair<ECategories, std::string_view>, N> entries;
+        std::ranges::transform(model, entries.begin(), [](const auto& def) { return std::pair {def.cat, def.name}; });
+        serialized_categories.clear();
+        alpaca::serialize(entries, serialized_categories);
+    }
+
     template<typename ECategories>
     auto deserialize_and_verify() -> bool
     {
@@ -0,0 +1,76 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#pragma once
+
+#include "spark/spark_export.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace spark::details
+{
+
+/**
+ * Open addressing hash index of the filled positions of a sparse category.
+ *
+ * Each inserted position receives the next free slot of the storage array, so the slots are always 0..size()-1 and
+ * keys()[slot] gives back the position. The table stores only slot numbers and grows with the number of filled
+ * positions, never with the category volume. clear() visits only the filled buckets.
+ */
+class SPARK_EXPORT sparse_index
+{
+public:
+    /**
+     * Find the slot of position.
+     *
+     * \param pos position
+     * \return slot or -1 if position is not filled
+     */
+    auto find(size_t pos) const -> int;
+
+    /**
+     * Insert position if not filled yet.
+     *
+     * \param pos position
+     * \return slot of the position
+     */
+    auto insert(size_t pos) -> size_t;
+
+    /// Filled positions in order of insertion, i.e. indexed by slot
+    /// \return positions
+    auto keys() const -> std::span<const size_t> { return order; }
+
+    /// Number of filled positions
+    /// \return count
+    auto size() const -> size_t { return order.size(); }
+
+    /// Remove all positions, the table memory is kept for next use.
+    auto clear() -> void;
+
+    /// Heap memory held by the index
+    /// \return size in bytes
+    auto memory_usage() const -> size_t
+    {
+        return (table.capacity() * sizeof(uint32_t)) + (order.capacity() * sizeof(size_t));
+    }
+
+private:
+    static constexpr size_t initial_buckets = 64;
+
+    auto bucket_of(size_t pos) const -> size_t;
+    auto rehash(size_t n_buckets) -> void;
+
+    std::vector<uint32_t> table;  ///< slot + 1 of each bucket, 0 for empty bucket
+    std::vector<size_t> order;    ///< positions in order of insertion
+    size_t mask {0};              ///< number of buckets - 1
+};
+
+}  // namespace spark::details
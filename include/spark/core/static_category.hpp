@@ -0,0 +1,185 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#pragma once
+
+#include "spark/core/category.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include <TClass.h>
+
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+namespace spark
+{
+
+/**
+ * \class static_category
+ * \ingroup lib_core
+ *
+ * Compile-time shaped view of a category.
+ *
+ * The dimension sizes are template parameters, thus the offsets are constexpr and the address arithmetic is unrolled
+ * into a chain of multiply-adds without any runtime dimension check. Locators are std::array of fixed length, so the
+ * dimension mismatch is a compile error. The object wraps a regular category built by the category_manager, so the
+ * writer, reader and all the runtime code see a normal category.
+ *
+ * Usage:
+ *
+ *     auto cat = spark::static_category<ExampleCal, 64>(model()->build_category<ExampleCal>(cat_id));
+ *     auto obj = cat.make_object_unsafe({12});
+ */
+template<typename T, size_t... Sizes>
+class static_category
+{
+public:
+    static constexpr size_t dim = sizeof...(Sizes);
+
+    static_assert(dim > 0, "Category must have at least one dimension");
+    static_assert(((Sizes > 0) && ...), "Category dimension sizes must be positive");
+    static_assert(((Sizes <= size_t {std::numeric_limits<uint16_t>::max()} + 1) && ...),
+                  "Category dimension size exceeds locator range");
+
+    using locator = std::array<uint16_t, dim>;
+
+    static constexpr std::array<size_t, dim> sizes {Sizes...};
+    static constexpr size_t data_size = (Sizes * ...);
+
+    /// Offsets of each dimension, see details::setup_header()
+    static constexpr std::array<size_t, dim> offsets = []
+    {
+        constexpr std::array<size_t, dim> szs {Sizes...};
+        std::array<size_t, dim> offs {};
+        size_t volume {1};
+        for (size_t i = dim; i > 0; --i) {
+            offs[i - 1] = volume;
+            volume *= szs[i - 1];
+        }
+        return offs;
+    }();
+
+    static_category() = default;
+
+    /**
+     * Wrap the category. The category must have the same shape and store objects of class T.
+     *
+     * \param cat category object
+     */
+    explicit static_category(category* cat)
+        : cat_ptr {cat}
+    {
+        if (cat_ptr == nullptr) {
+            throw std::invalid_argument("Cannot wrap null category");
+        }
+
+        const auto& cat_sizes = cat_ptr->get_sizes();
+        if (!std::equal(cat_sizes.begin(), cat_sizes.end(), sizes.begin(), sizes.end())) {
+            throw std::runtime_error(fmt::format("Category {} shape {} does not match static shape {}",
+                                                 cat_ptr->get_name().Data(),
+                                                 cat_sizes,
+                                                 sizes));
+        }
+
+        if (cat_ptr->get_class() != TClass::GetClass<T>()) {
+            throw std::runtime_error(
+                fmt::format("Category {} does not store objects of requested class", cat_ptr->get_name().Data()));
+        }
+    }
+
+    /**
+     * Translate locator into linear position.
+     *
+     * \param loc locator
+     * \return linear position
+     */
+    static constexpr auto loc2pos(const locator& loc) -> size_t
+    {
+        return loc2pos_impl(loc, std::make_index_sequence<dim> {});
+    }
+
+    /**
+     * Translate locator given as template arguments into linear position. Every coordinate is checked at compile time.
+     *
+     * \return linear position
+     */
+    template<size_t... Loc>
+    static constexpr auto pos() -> size_t
+    {
+        static_assert(sizeof...(Loc) == dim, "Dimension of locator does not fit to category");
+        if constexpr (sizeof...(Loc) == dim) {
+            static_assert(((Loc < Sizes) && ...), "Locator out of category range");
+        }
+        return loc2pos(locator {static_cast<uint16_t>(Loc)...});
+    }
+
+    /**
+     * Converts linear position into locator.
+     *
+     * \param pos linear position
+     * \return locator
+     */
+    static constexpr auto pos2loc(size_t pos) -> locator
+    {
+        locator loc {};
+        for (size_t i = 0; i < dim; ++i) {
+            loc[i] = static_cast<uint16_t>(pos / offsets[i]);
+            pos %= offsets[i];
+        }
+        return loc;
+    }
+
+    auto get_slot(const locator& loc) -> T*& { return cat_ptr->get_slot_at<T>(loc2pos(loc)); }
+
+    auto get_object(const locator& loc) -> T* { return cat_ptr->get_object_at<T>(loc2pos(loc)); }
+
+    auto make_object_unsafe(const locator& loc) -> T* { return cat_ptr->make_object_at<T>(loc2pos(loc)); }
+
+    template<size_t... Loc>
+    auto get_object() -> T*
+    {
+        return cat_ptr->get_object_at<T>(pos<Loc...>());
+    }
+
+    template<size_t... Loc>
+    auto make_object_unsafe() -> T*
+    {
+        return cat_ptr->make_object_at<T>(pos<Loc...>());
+    }
+
+    /// Returns locator of the object at given index
+    /// \param idx object index
+    /// \return locator
+    auto get_locator(types::dim_t idx) const -> locator { return pos2loc(cat_ptr->get_position(idx)); }
+
+    /// Returns wrapped category
+    /// \return category
+    auto get() const -> category* { return cat_ptr; }
+
+    auto operator->() const -> category* { return cat_ptr; }
+
+    operator category*() const { return cat_ptr; }
+
+private:
+    template<size_t... Is>
+    static constexpr auto loc2pos_impl(const locator& loc, std::index_sequence<Is...> /*unused*/) -> size_t
+    {
+        return ((size_t {loc[Is]} * offsets[Is]) + ...);
+    }
+
+    category* cat_ptr {nullptr};  ///< wrapped category
+};
+
+}  // namespace spark
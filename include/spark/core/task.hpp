@@ -10,6 +10,9 @@
 
 #include "spark/spark_export.hpp"
 
+#include <cstddef>
+#include <memory>
+
 #include <spdlog/spdlog.h>
 
 namespace spark
@@ -40,8 +43,38 @@ public:
 
     virtual auto execute() -> bool { return true; }
 
+    /**
+     * Execute task for all events of the batch, see category_manager::set_batch(). The default implementation selects
+     * each event of the batch in turn and calls execute(), thus it is not faster than the per-event loop. Tasks
+     * override it to process the whole batch at once, e.g. via category_manager::batch_handle().
+     *
+     * \param n_events number of events in the batch
+     * \return success
+     */
+    virtual auto execute_batch(size_t n_events) -> bool;
+
     virtual auto deinit() -> bool { return true; }
 
+    /**
+     * Create an instance of the task for a worker of the parallel event loop, see writer::tree::set_workers(). The
+     * replica works on the worker's category manager and is initialized separately, so all per-event state of the
+     * task must be held by the instance. The default returns nullptr, which means the task does not support the
+     * parallel mode.
+     *
+     *     auto replicate(category_manager* catmgr, database* dbmgr) const -> std::unique_ptr<task> override
+     *     {
+     *         return std::make_unique<my_task>(catmgr, dbmgr);
+     *     }
+     *
+     * \param catmgr category manager of the worker
+     * \param dbmgr parameters database
+     * \return new task instance or nullptr
+     */
+    virtual auto replicate(category_manager* /*catmgr*/, database* /*dbmgr*/) const -> std::unique_ptr<task>
+    {
+        return nullptr;
+    }
+
     auto model() -> category_manager* { return cat_mgr; }
 
     auto db() -> database* { return db_mgr; }
@@ -18,6 +18,7 @@
 
 #include <format>
 #include <map>
+#include <memory>
 
 #include <spdlog/spdlog.h>
 
@@ -110,6 +111,14 @@ public:
      */
     auto execute_tasks() -> void;
 
+    /**
+     * Call execute_batch() of each registered task, so each task processes all events of the batch before the next
+     * task starts.
+     *
+     * \param n_events number of events in the batch
+     */
+    auto execute_tasks_batch(size_t n_events) -> void;
+
     /**
      * Call deinit() of each registered task.
      */
@@ -117,6 +126,15 @@ public:
 
     auto init_unpackers() -> void;
 
+    /**
+     * Create task manager with replicas of all tasks, see task::replicate(), in the same execution order. The tasks
+     * are not initialized and the unpackers are not copied, they belong to the sources.
+     *
+     * \param mgr category manager of the replicas
+     * \return task manager
+     */
+    auto replicate(category_manager* mgr) const -> std::unique_ptr<task_manager>;
+
     auto model() -> category_manager* { return cat_mgr; }
 
     auto db() -> database* { return db_mgr; }
@@ -0,0 +1,146 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#pragma once
+
+#include "spark/spark_config.hpp"
+#include "spark/spark_export.hpp"
+
+#include "spark/core/category.hpp"
+#include "spark/core/category_manager.hpp"
+#include "spark/core/category_model.hpp"
+#include "spark/core/spark_dep.hpp"
+#include "spark/core/task_manager.hpp"
+#include "spark/parameters/database.hpp"
+#include "spark/spark.hpp"
+
+#include <ROOT/REntry.hxx>
+#include <ROOT/RNTupleFillContext.hxx>
+#include <ROOT/RNTupleParallelWriter.hxx>
+#include <ROOT/RNTupleWriteOptions.hxx>
+
+#include <TFile.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace spark::writer
+{
+
+/**
+ * \class ntuple
+ * \ingroup core
+ *
+ * Writes the persistent categories into an RNTuple. Each category is mapped to two fields: the objects in order of
+ * their positions, as a collection std::vector<T> named after the category, thus each member of T is stored in its own
+ * column, and the linear positions of the objects, as std::vector<std::uint64_t> named <category>_pos. The locators are
+ * recovered from the positions and the category shape. The objects are copied by value, thus the class must be
+ * copyable and known at compile time, i.e. the category is declared in the model or built with build_category<T>(),
+ * other categories are skipped. The constructor and process_data() follow tree, the sparksys::create_writer() creates
+ * both.
+ *
+ * The output goes through the RNTuple parallel writer. In the parallel event loop, see set_workers(), each worker
+ * fills its own fill context, thus the serialisation and compression of the clusters run in the workers and no
+ * output stage is needed. The entries are then written in the order of completion of the clusters.
+ */
+class SPARK_EXPORT ntuple : public spark_dep
+{
+public:
+    /**
+     * Creates a new file and the RNTuple model with the output categories.
+     *
+     * \param sprk spark system
+     * \param ntuple_name RNTuple name
+     * \param file_name output file name
+     */
+    ntuple(sparksys* sprk, std::string_view ntuple_name, std::string_view file_name);
+
+    /**
+     * Loop ever entries and commit the RNTuple at the end.
+     *
+     * \param entries number to entries to loop over, 0 for all
+     * \param show_progress_bar display progress bar
+     */
+    auto process_data(uint64_t entries, bool /*show_progress_bar*/ = true) -> void;
+
+    /**
+     * Enable the parallel event loop. The sources read the events in a separate thread and n workers run the tasks,
+     * each with its own replica of the tasks, see task::replicate(), and fill the output. The model must have at least
+     * n event buffers, see category_manager::set_buffers(). Cannot be combined with the batch mode.
+     *
+     * \param n number of workers, 1 or less disables the parallel mode
+     */
+    auto set_workers(size_t n) -> void { n_workers = n; }
+
+    auto model() -> category_manager& { return spark()->model(); }
+
+    auto pardb() -> database& { return spark()->pardb(); }
+
+    auto tasks() -> task_manager& { return spark()->tasks(); }
+
+private:
+    /// Fields of a category in the entry
+    struct category_fields
+    {
+        ROOT::REntry::RFieldToken objects;    ///< collection of the objects
+        ROOT::REntry::RFieldToken positions;  ///< positions of the objects
+        category** cat {nullptr};             ///< category of the manager
+        copy_objects_fn copy {nullptr};       ///< copy of the objects into the collection
+    };
+
+    /// Fill context with its entry filled from the categories of a manager
+    struct output_context
+    {
+        std::shared_ptr<ROOT::Experimental::RNTupleFillContext> fill_context;  ///< fill context
+        std::unique_ptr<ROOT::REntry> entry;                                   ///< entry of the context
+        std::vector<category_fields> fields;                                   ///< fields of the categories
+    };
+
+    /// Create fill context for categories of the manager
+    /// \param cat_mgr manager or its view
+    /// \return context
+    auto make_context(category_manager& cat_mgr) -> output_context;
+
+    /// Copy the current categories into the entry and fill it
+    /// \param ctx output context
+    static auto fill_entry(output_context& ctx) -> void;
+
+    /// Read the event from all sources
+    /// \param event event number
+    /// \return false if any source has no more events
+    auto read_event(uint64_t event) -> bool;
+
+    /// Events loop in the calling thread
+    /// \param max_events maximal number of events
+    /// \param progress called before processing each event
+    /// \return number of processed events
+    auto process_serial(uint64_t max_events, const std::function<void(uint64_t)>& progress) -> uint64_t;
+
+    /// Events loop with the tasks and the output running in parallel workers, see set_workers()
+    /// \param max_events maximal number of events
+    /// \param progress called before processing each event
+    /// \return number of processed events
+    auto process_parallel(uint64_t max_events, const std::function<void(uint64_t)>& progress) -> uint64_t;
+
+    size_t n_workers {1};           ///< Number of workers of the parallel event loop
+    std::vector<uint16_t> written;  ///< IDs of categories written to the output, sorted
+
+    std::unique_ptr<TFile> output_file {nullptr};  ///< Pointer to output file
+    std::string output_file_name;                  ///< Output file name
+
+    /// RNTuple writer, declared after the file, thus it commits before the file is closed
+    std::unique_ptr<ROOT::Experimental::RNTupleParallelWriter> writer {nullptr};
+    std::string output_ntuple_name;  ///< RNTuple name
+};
+
+}  // namespace spark::writer
@@ -13,6 +13,7 @@
 
 #include "spark/core/category.hpp"
 #include "spark/core/category_manager.hpp"
+#include "spark/core/column_category.hpp"
 #include "spark/core/data_source.hpp"
 #include "spark/core/root_file_header.hpp"
 #include "spark/core/spark_dep.hpp"
@@ -28,9 +29,19 @@
 #include <TTree.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <initializer_list>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -39,6 +50,58 @@
 namespace spark::writer
 {
 
+/// Order of the events in the output of the parallel event loop
+enum class output_order : uint8_t
+{
+    ordered,      ///< same as the input order
+    unordered,    ///< order of completion, no reordering buffer needed
+    independent,  ///< each worker writes its own files, see tree::set_workers()
+};
+
+/**
+ * Policy of the output files rotation, see tree::set_rotation(). A new file is started when the current one reached
+ * any of the limits, 0 disables the limit.
+ */
+struct rotation_policy
+{
+    uint64_t max_events {0};  ///< maximal number of events in a file
+    uint64_t max_bytes {0};   ///< maximal number of bytes written to a file
+};
+
+/// Entry of the output manifest, one per output file, see tree::get_manifest()
+struct manifest_entry
+{
+    std::string file;          ///< file name
+    std::string stream;        ///< writer of the file, main or worker w<k>
+    uint64_t first_entry {0};  ///< first entry of the file within its stream
+    uint64_t entries {0};      ///< number of entries in the file
+};
+
+/**
+ * Policy of the adaptive layout of the output tree, see tree::set_layout(). After the warm-up events the bytes per
+ * event of each branch are measured, the cluster size in entries is chosen to match the target bytes and each basket
+ * is sized to hold one cluster of its branch, within the limits.
+ */
+struct layout_policy
+{
+    uint64_t warmup_events {1000};            ///< events measured before the layout is chosen
+    size_t cluster_bytes {30 * 1024 * 1024};  ///< target uncompressed size of a cluster
+    size_t min_basket {4 * 1024};             ///< smallest basket size
+    size_t max_basket {2 * 1024 * 1024};      ///< largest basket size, bounds the memory used by each branch
+};
+
+/**
+ * Time the stages of the event loop spent waiting for each other, see tree::get_stalls(). Long waits of the tasks for
+ * the output mean the job is output bound, long waits of the output for the tasks mean it is processing bound.
+ */
+struct loop_stalls
+{
+    std::chrono::nanoseconds sources {0};      ///< sources waiting for a free buffer
+    std::chrono::nanoseconds processing {0};   ///< tasks waiting for the sources
+    std::chrono::nanoseconds output_full {0};  ///< tasks waiting for the output queue
+    std::chrono::nanoseconds output_idle {0};  ///< output waiting for the tasks
+};
+
 /**
  * \class sparksys
  * \ingroup core
@@ -140,6 +203,8 @@ namespace spark::writer
 class SPARK_EXPORT tree : public spark_dep
 {
 public:
+    static constexpr Int_t default_basket_size = 16000;  ///< basket size of the branches until the layout is applied
+
     /**
      * Creates a new file and an empty root tree with output categories.
      * \param with_tree create output tree
@@ -162,12 +227,128 @@ public:
     }
 
     /**
-     * Loop ever entries.
+     * Loop ever entries. If the model has more than one event buffer, see category_manager::set_buffers(), the sources
+     * read next events in a separate thread, overlapping the input with processing. In batch mode, see
+     * category_manager::set_batch(), the tasks are called and the categories compressed once per batch of events.
+     *
      * \param entries number to entries to loop over
      * \param show_progress_bar display progress bar
      */
     auto process_data(uint64_t entries, bool /*show_progress_bar*/ = true) -> void;
 
+    /**
+     * Enable the parallel event loop. The sources read the events in a separate thread, n workers run the tasks, each
+     * with its own replica of the tasks, see task::replicate(), and the calling thread fills the output. The model
+     * must have at least n event buffers, see category_manager::set_buffers(), more buffers let the sources read
+     * ahead. Cannot be combined with the batch mode and the columnar outputs.
+     *
+     * In the independent order each worker fills its own files named <stem>_w<k>.root, rotated as the main file, see
+     * set_rotation(), and the main file keeps only an empty tree. The adaptive layout applies to the main file only.
+     *
+     * \param n number of workers, 1 or less disables the parallel mode
+     * \param order order of the events in the output
+     */
+    auto set_workers(size_t n, output_order order = output_order::ordered) -> void
+    {
+        n_workers = n;
+        workers_order = order;
+    }
+
+    /**
+     * Fill the output in a separate thread. The tasks pass the completed events to the output thread through a queue
+     * of the given depth and continue with next event while the previous ones are streamed, compressed and written.
+     * When the queue is full the tasks wait. Each queued event occupies its event buffer until it is written, thus the
+     * model needs at least 2 event buffers, see category_manager::set_buffers(). Cannot be combined with the batch
+     * mode and the columnar outputs. The parallel event loop always fills the output in the calling thread, separate
+     * from the workers, and ignores this setting.
+     *
+     * \param depth maximal number of queued events, 0 fills the output in the processing thread
+     */
+    auto set_output_queue(size_t depth) -> void { output_depth = depth; }
+
+    /**
+     * Enable the adaptive layout of the output tree. The auto-flush is disabled during the warm-up, then the baskets
+     * are flushed, the basket sizes and the cluster size are set and recorded in the user info of the tree as
+     * TParameter objects named layout.cluster_entries, and layout.<branch>.bytes_per_event and
+     * layout.<branch>.basket_size for each branch at every level, including the sub-branches of the split categories.
+     * The bytes per event of a branch do not include its sub-branches.
+     *
+     * \param policy layout policy
+     */
+    auto set_layout(const layout_policy& policy) -> void;
+
+    /**
+     * Enable the rotation of the output files. The first file has the name given to the constructor, next files of
+     * <stem>.root are named <stem>_1.root, <stem>_2.root and so on. Each file gets the file header and the complete
+     * tree, the files are rotated between events. With rotation or independent workers the list of files with their
+     * entry ranges is written to <stem>.manifest at the end of the loop, see get_manifest(). Cannot be combined with
+     * the pass-through categories.
+     *
+     * \param policy rotation policy
+     */
+    auto set_rotation(const rotation_policy& policy) -> void { rotation = policy; }
+
+    /// Output files written by the last event loop
+    /// \return manifest entries
+    auto get_manifest() const -> const std::vector<manifest_entry>& { return manifest; }
+
+    /// Name of the rotated output file, see set_rotation()
+    /// \param base base file name
+    /// \param index file index
+    /// \return file name
+    static auto rotated_name(const std::string& base, size_t index) -> std::string;
+
+    /// Append suffix to the file name stem, <stem>.root becomes <stem>_<suffix>.root
+    /// \param base base file name
+    /// \param suffix suffix
+    /// \return file name
+    static auto suffixed_name(const std::string& base, std::string_view suffix) -> std::string;
+
+    /// Waiting times of the stages of the last buffered or parallel event loop
+    /// \return stalls
+    auto get_stalls() const -> const loop_stalls& { return stalls; }
+
+    /**
+     * Add columnar output, see column_category. Each column is written as a separate branch and the columns are
+     * cleared together with the categories at the beginning of each event. Only the serial event loop supports the
+     * columnar outputs, the buffered, batched and parallel loops reject them.
+     *
+     * \param cols columns object, must outlive the writer
+     */
+    auto add_columns(column_store& cols) -> void;
+
+    /**
+     * Forward categories of the input tree to the output without reading them. The pass-through branches are written
+     * into a friend tree of the output tree named <tree>_pass.
+     *
+     * The copy is done once, after the events loop, not while the output advances. The compressed baskets are copied
+     * directly from the input (fast cloning, no objects are created) only if all input entries were processed. A
+     * partial run, e.g. process_data() with fewer entries than the input, copies the processed entries with the
+     * regular streaming, which reads and writes every object.
+     *
+     * The friend tree is not split together with the output tree, thus the pass-through cannot be combined with the
+     * rotation of the output files, see set_rotation(), nor with the independent output of the workers, see
+     * set_workers(), process_data() throws std::logic_error in both cases. The categories must not be written by the
+     * tasks. The input tree must have one entry per processed event.
+     *
+     * \param input input tree, e.g. reader::tree::chain()
+     * \param categories categories to forward
+     */
+    template<CategoryEnum ECategories>
+    auto add_pass_through(TChain* input, std::initializer_list<ECategories> categories) -> void
+    {
+        std::vector<std::string> names;
+        for (auto cat : categories) {
+            const auto& cinfo = model().get_category_info(cat);
+            if (!cinfo.registered) {
+                throw std::out_of_range(std::format("Category with id {} not registered", cinfo.cat_id));
+            }
+            names.emplace_back(cinfo.name);
+        }
+
+        setup_pass_through(input, names);
+    }
+
     auto model() -> category_manager& { return spark()->model(); }
 
     auto pardb() -> database& { return spark()->pardb(); }
@@ -175,13 +356,121 @@ public:
     auto tasks() -> task_manager& { return spark()->tasks(); }
 
 private:
+    /// Read the event from all sources
+    /// \param event event number
+    /// \return false if any source has no more events
+    auto read_event(uint64_t event) -> bool;
+
+    /// Run the tasks and fill the event into the tree
+    auto fill_event() -> void;
+
+    /// Fill the output tree and apply the layout at the end of the warm-up
+    auto fill_output() -> void;
+
+    /// Choose and apply the layout from the warm-up events, see set_layout()
+    auto apply_layout() -> void;
+
+    /**
+     * Create the output file with the tree and the branches of the persistent categories.
+     *
+     * \param file_name file name
+     * \param cat_mgr model or its view
+     * \param target member of category_info the branches point at
+     * \param file created file
+     * \param out_tree created tree
+     * \param with_header write the file header
+     */
+    auto open_file(const std::string& file_name,
+                   category_manager& cat_mgr,
+                   category* category_info::* target,
+                   std::unique_ptr<TFile>& file,
+                   std::unique_ptr<TTree>& out_tree,
+                   bool with_header) -> void;
+
+    /**
+     * Write the tree, close the file and record it in the manifest.
+     *
+     * \param stream writer of the file
+     * \param first_entry first entry of the file within the stream
+     * \param file file to close
+     * \param out_tree tree of the file
+     */
+    auto close_file(const std::string& stream,
+                    uint64_t first_entry,
+                    std::unique_ptr<TFile>& file,
+                    std::unique_ptr<TTree>& out_tree) -> void;
+
+    /// Rotation of the output files is enabled
+    /// \return rotation enabled
+    auto rotating() const -> bool { return rotation.max_events > 0 or rotation.max_bytes > 0; }
+
+    /// Current file reached the rotation limits
+    /// \param file output file
+    /// \param out_tree output tree
+    /// \return file is full
+    auto file_full(TFile* file, TTree* out_tree) const -> bool;
+
+    /// Close the current main file and continue in the next one
+    auto rotate() -> void;
+
+    /// Write the manifest of the output files
+    auto write_manifest() const -> void;
+
+    /// Events loop with the sources reading ahead into free event buffers
+    /// \param max_events maximal number of events
+    /// \param progress called before processing each event
+    /// \return number of processed events
+    auto process_buffered(uint64_t max_events, const std::function<void(uint64_t)>& progress) -> uint64_t;
+
+    /// Events loop processing batches of events, see category_manager::set_batch()
+    /// \param max_events maximal number of events
+    /// \param progress called before filling each event
+    /// \return number of processed events
+    auto process_batched(uint64_t max_events, const std::function<void(uint64_t)>& progress) -> uint64_t;
+
+    /// Events loop with the tasks running in parallel workers, see set_workers()
+    /// \param max_events maximal number of events
+    /// \param progress called before filling each event
+    /// \return number of processed events
+    auto process_parallel(uint64_t max_events, const std::function<void(uint64_t)>& progress) -> uint64_t;
+
+    /// Create the pass-through tree with the given branches of the input
+    /// \param input input tree
+    /// \param names branch names
+    auto setup_pass_through(TChain* input, std::span<const std::string> names) -> void;
+
+    /// Print waiting times of the stages
+    auto print_stalls() const -> void;
+
+    /// Copy the pass-through branches of the processed events
+    /// \param events number of processed events
+    auto copy_pass_through(uint64_t events) -> void;
+
+    std::vector<column_store*> columns;                  ///< Columnar outputs
+    size_t n_workers {1};                                ///< Number of workers of the parallel event loop
+    output_order workers_order {output_order::ordered};  ///< Order of the output of the parallel event loop
+    size_t output_depth {0};                             ///< Depth of the asynchronous output queue
+    loop_stalls stalls;                                  ///< Waiting times of the last event loop
+    layout_policy layout;                                ///< Adaptive layout of the output tree
+    bool layout_enabled {false};                         ///< Adaptive layout is used
+    bool layout_pending {false};                         ///< Layout is applied after the warm-up
+    rotation_policy rotation;                            ///< Rotation of the output files
+    std::vector<manifest_entry> manifest;                ///< Closed output files
+    std::mutex files_mutex;                              ///< Guards opening and closing of files and the manifest
+    size_t file_index {0};                               ///< Index of the current main file
+    uint64_t file_first_entry {0};                       ///< First entry of the current main file
+
     std::unique_ptr<TFile> output_file {nullptr};  ///< Pointer to output file
     std::string output_file_name;                  ///< Output file name
+    std::string current_file_name;                 ///< Name of the current main file
+
+    std::unique_ptr<TChain> pass_input {nullptr};  ///< Input of the pass-through categories
+    std::unique_ptr<TTree> pass_tree {nullptr};    ///< Friend tree with the pass-through categories
 
     std::unique_ptr<TTree> output_tree {nullptr};  ///< Pointer to output tree
     std::string output_tree_name;
 
-    std::map<uint16_t, category> cat_obj;          ///< Map of categories
+    std::map<uint16_t, category> cat_obj;  ///< Map of categories
 };
 
 }  // namespace spark::writer
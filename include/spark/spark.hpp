@@ -200,6 +200,21 @@ public:
 
     auto model() -> category_manager& { return cat_mgr; }
 
+    /**
+     * Register the compile-time categories model and record it in the file header.
+     *
+     * \param cat_model categories model
+     */
+    template<CategoryEnum ECategories, size_t N>
+    auto use_model(const category_model<ECategories, N>& cat_model) -> void
+    {
+        file_header.serialize(cat_model);
+        cat_mgr.register_model(cat_model);
+    }
+
+    /// Write the file header into the current directory, each output file gets its copy
+    auto write_file_header() -> void { file_header.Write("FileHeader"); }
+
     auto pardb() -> database& { return par_db; }
 
     auto tasks() -> task_manager& { return task_mgr; }
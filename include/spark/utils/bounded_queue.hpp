@@ -0,0 +1,147 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace spark::utils
+{
+
+/**
+ * Blocking FIFO queue of limited capacity for passing work between threads.
+ *
+ * push() waits while the queue is full, pop() waits while it is empty. After close() no more elements are accepted,
+ * the remaining ones can be still popped and then pop() returns std::nullopt, which tells the consumer to stop.
+ *
+ * The time spent waiting in push() and pop() is accumulated, it tells which side of the queue is the bottleneck.
+ */
+template<typename T>
+class bounded_queue
+{
+public:
+    /**
+     * Constructor
+     *
+     * \param max_size capacity of the queue, at least 1
+     */
+    explicit bounded_queue(size_t max_size)
+        : capacity {max_size > 0 ? max_size : 1}
+    {
+    }
+
+    /**
+     * Append element, wait if the queue is full.
+     *
+     * \param value element
+     * \return false if the queue was closed and the element was dropped
+     */
+    auto push(T value) -> bool
+    {
+        {
+            std::unique_lock lock(mutex);
+            const auto ready = [this] { return closed or items.size() < capacity; };
+            if (!ready()) {
+                const auto start = clock::now();
+                not_full.wait(lock, ready);
+                push_wait += clock::now() - start;
+            }
+            if (closed) {
+                return false;
+            }
+            items.push_back(std::move(value));
+        }
+        not_empty.notify_one();
+        return true;
+    }
+
+    /**
+     * Take the oldest element, wait if the queue is empty.
+     *
+     * \return element or std::nullopt if the queue is closed and empty
+     */
+    auto pop() -> std::optional<T>
+    {
+        std::optional<T> value;
+        {
+            std::unique_lock lock(mutex);
+            const auto ready = [this] { return closed or !items.empty(); };
+            if (!ready()) {
+                const auto start = clock::now();
+                not_empty.wait(lock, ready);
+                pop_wait += clock::now() - start;
+            }
+            if (items.empty()) {
+                return std::nullopt;
+            }
+            value.emplace(std::move(items.front()));
+            items.pop_front();
+        }
+        not_full.notify_one();
+        return value;
+    }
+
+    /// Stop accepting elements and wake up all waiting threads
+    auto close() -> void
+    {
+        {
+            std::lock_guard lock(mutex);
+            closed = true;
+        }
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+
+    /// Number of queued elements
+    /// \return size
+    auto size() const -> size_t
+    {
+        std::lock_guard lock(mutex);
+        return items.size();
+    }
+
+    /// Maximal number of queued elements
+    /// \return capacity
+    auto get_capacity() const -> size_t { return capacity; }
+
+    /// Total time spent in push() waiting for free space, the consumer is slower
+    /// \return waiting time
+    auto push_stall() const -> std::chrono::nanoseconds
+    {
+        std::lock_guard lock(mutex);
+        return push_wait;
+    }
+
+    /// Total time spent in pop() waiting for elements, the producer is slower
+    /// \return waiting time
+    auto pop_stall() const -> std::chrono::nanoseconds
+    {
+        std::lock_guard lock(mutex);
+        return pop_wait;
+    }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    const size_t capacity;                   ///< maximal number of elements
+    mutable std::mutex mutex;                ///< guards all members below
+    std::condition_variable not_full;        ///< signalled when element is popped
+    std::condition_variable not_empty;       ///< signalled when element is pushed
+    std::deque<T> items;                     ///< queued elements
+    bool closed {false};                     ///< no more elements accepted
+    std::chrono::nanoseconds push_wait {0};  ///< time spent waiting in push()
+    std::chrono::nanoseconds pop_wait {0};   ///< time spent waiting in pop()
+};
+
+}  // namespace spark::utils
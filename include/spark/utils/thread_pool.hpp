@@ -0,0 +1,150 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace spark::utils
+{
+
+/**
+ * Fixed size pool of worker threads for fork-join loops.
+ *
+ * parallel_for() distributes the iterations over the workers and the calling thread, and returns when all of them are
+ * done. The job is passed without any allocation, so the pool can be used at every event boundary. The first exception
+ * thrown by the job is rethrown in the calling thread.
+ */
+class thread_pool
+{
+public:
+    /**
+     * Constructor
+     *
+     * \param n_workers number of worker threads, the calling thread participates in addition
+     */
+    explicit thread_pool(size_t n_workers)
+    {
+        workers.reserve(n_workers);
+        for (size_t i = 0; i < n_workers; ++i) {
+            workers.emplace_back([this] { work(); });
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool(thread_pool&&) = delete;
+
+    auto operator=(const thread_pool&) -> thread_pool& = delete;
+    auto operator=(thread_pool&&) -> thread_pool& = delete;
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        start_cv.notify_all();
+    }
+
+    /// Number of threads executing the loop, including the calling thread
+    /// \return number of threads
+    auto size() const -> size_t { return workers.size() + 1; }
+
+    /**
+     * Call func(i) for every i in [0, n) and wait for completion.
+     *
+     * \param n number of iterations
+     * \param func job, must be safe to call concurrently for different i
+     */
+    template<typename F>
+    auto parallel_for(size_t n, F&& func) -> void
+    {
+        using func_t = std::remove_reference_t<F>;
+
+        {
+            std::lock_guard lock(mutex);
+            job_ctx = static_cast<void*>(&func);
+            job_call = [](void* ctx, size_t idx) { (*static_cast<func_t*>(ctx))(idx); };
+            job_size = n;
+            next.store(0, std::memory_order_relaxed);
+            finished = 0;
+            error = nullptr;
+            ++generation;
+        }
+        start_cv.notify_all();
+
+        run_jobs();
+
+        std::unique_lock lock(mutex);
+        done_cv.wait(lock, [this] { return finished == workers.size(); });
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    auto work() -> void
+    {
+        size_t seen {0};
+        while (true) {
+            {
+                std::unique_lock lock(mutex);
+                start_cv.wait(lock, [&] { return stopping or generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+
+            run_jobs();
+
+            {
+                std::lock_guard lock(mutex);
+                ++finished;
+            }
+            done_cv.notify_one();
+        }
+    }
+
+    auto run_jobs() -> void
+    {
+        for (auto idx = next.fetch_add(1); idx < job_size; idx = next.fetch_add(1)) {
+            try {
+                job_call(job_ctx, idx);
+            } catch (...) {
+                std::lock_guard lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    }
+
+    std::mutex mutex;                           ///< guards the job state
+    std::condition_variable start_cv;           ///< new job or stop
+    std::condition_variable done_cv;            ///< worker finished the job
+    void* job_ctx {nullptr};                    ///< job object
+    void (*job_call)(void*, size_t) {nullptr};  ///< job trampoline
+    size_t job_size {0};                        ///< number of iterations
+    std::atomic<size_t> next {0};               ///< next iteration to take
+    size_t generation {0};                      ///< job counter
+    size_t finished {0};                        ///< workers done with current job
+    std::exception_ptr error;                   ///< first exception of the job
+    bool stopping {false};                      ///< pool is being destroyed
+    std::vector<std::jthread> workers;          ///< worker threads, joined last
+};
+
+}  // namespace spark::utils
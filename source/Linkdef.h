@@ -17,7 +17,13 @@
 #pragma link C++ nestedclasses;
 #pragma link C++ nestedtypedefs;
 
-#pragma link C++ class spark::details::category_internals+;
+#pragma link C++ enum spark::storage_mode;
+#pragma link C++ class spark::details::occupancy_index+;
+#pragma link C++ class spark::details::category_internals-;
+// files written before the occupancy index keep the compressed positions as keys of the index map
+#pragma read sourceClass="spark::details::category_internals" targetClass="spark::details::category_internals" \
+    version="[-1]" source="std::map<unsigned long, int> idxmap" target="positions" \
+    code="{ positions.clear(); for (const auto& [pos, idx] : onfile.idxmap) { positions.push_back(pos); } }"
 #pragma link C++ class spark::category+;
 
 // database and parameters
@@ -17,11 +17,14 @@
 #include <initializer_list>
 #include <iterator>
 #include <numeric>
+#include <span>
 #include <stdexcept>
 #include <utility>
 #include <vector>
 
+#include <TBuffer.h>
 #include <TClass.h>
+#include <TClonesArray.h>
 #include <TObject.h>
 
 #include <fmt/base.h>
@@ -46,13 +49,17 @@ namespace spark
 namespace details
 {
 
-auto setup_header(category_internals& header, const char* name, std::initializer_list<size_t> sizes, bool simulation)
-    -> void
+auto setup_header(category_internals& header,
+                  const char* name,
+                  std::span<const size_t> sizes,
+                  bool simulation,
+                  storage_mode mode) -> void
 {
     header.name = name;
     header.dim = sizes.size();
     header.simulation = simulation;
-    header.sizes = sizes;
+    header.mode = mode;
+    header.sizes.assign(sizes.begin(), sizes.end());
     header.offsets.reserve(header.dim);
     header.offsets.push_back(1);
 
@@ -62,7 +69,7 @@ auto setup_header(category_internals& header, const char* name, std::initializer
      *
      * Thus, the offsets array is {20, 4, 1} See tests for examples.
      */
-    std::vector<size_t> tmp = sizes;
+    std::vector<size_t> tmp(sizes.begin(), sizes.end());
     std::reverse(tmp.begin(), tmp.end());  // One need to reverse the sizes
 
     // Skip the last element because its offset is always 1.
@@ -71,6 +78,11 @@ auto setup_header(category_internals& header, const char* name, std::initializer
 
     namespace rng = std::ranges;
     header.data_size = rng::fold_left(sizes, 1, std::multiplies());
+
+    // Sparse storage must not allocate anything proportional to the volume
+    if (mode == storage_mode::dense) {
+        header.index.resize(header.data_size);
+    }
 }
 
 auto category_internals::set_map_index(size_t pos, int val) -> bool
@@ -80,11 +92,60 @@ auto category_internals::set_map_index(size_t pos, int val) -> bool
         // throw std::runtime_error("Category is already compressed");
     }
 
-    idxmap[pos] = val;
+    if (pos >= data_size) {
+        throw std::out_of_range(fmt::format("Position {} exceeds category {} size {}", pos, name, data_size));
+    }
+
+    if (mode == storage_mode::sparse) {
+        sparse.insert(pos);
+        return true;
+    }
+
+    assert(types::int2size_t(val) == pos);
+    index.set(pos);
 
     return true;
 }
 
+auto category_internals::acquire_slot(size_t pos) -> int
+{
+    if (compressed) {
+        return -1;
+    }
+
+    if (pos >= data_size) {
+        throw std::out_of_range(fmt::format("Position {} exceeds category {} size {}", pos, name, data_size));
+    }
+
+    if (mode == storage_mode::sparse) {
+        return types::size_t2int(sparse.insert(pos));
+    }
+
+    index.set(pos);
+    return types::size_t2int(pos);
+}
+
+auto category_internals::acquire_slots(std::span<const size_t> poss) -> std::span<const size_t>
+{
+    if (compressed or poss.empty()) {
+        return {};
+    }
+
+    const auto max_pos = std::ranges::max(poss);
+    if (max_pos >= data_size) {
+        throw std::out_of_range(fmt::format("Position {} exceeds category {} size {}", max_pos, name, data_size));
+    }
+
+    if (mode == storage_mode::sparse) {
+        batch_slots.resize(poss.size());
+        std::ranges::transform(poss, batch_slots.begin(), [this](size_t pos) { return sparse.insert(pos); });
+        return batch_slots;
+    }
+
+    index.set(poss);
+    return poss;
+}
+
 /**
  * Return map index for given position
  *
@@ -93,23 +154,88 @@ auto category_internals::set_map_index(size_t pos, int val) -> bool
  */
 auto category_internals::get_map_index(size_t pos) const -> int
 {
-    const auto& iter = idxmap.find(pos);
-    if (iter == idxmap.end()) {
+    if (mode == storage_mode::sparse) {
+        if (!compressed) {
+            return sparse.find(pos);
+        }
+
+        // Compressed positions are sorted, and the index is available also for the category read from file.
+        auto iter = std::ranges::lower_bound(positions, pos);
+        if (iter == positions.end() or *iter != pos) {
+            return -1;
+        }
+        return types::size_t2int(static_cast<size_t>(std::distance(positions.begin(), iter)));
+    }
+
+    if (!index.test(pos)) {
         return -1;
     }
-    return iter->second;
+    return types::size_t2int(compressed ? index.rank(pos) : pos);
 }
 
-auto category_internals::get_pos_by_index(int idx) -> size_t
+auto category_internals::size() const -> size_t
 {
-    auto find_result = std::find_if(
-        std::begin(idxmap), std::end(idxmap), [&](const std::pair<size_t, int>& pair) { return pair.second == idx; });
+    if (mode == storage_mode::sparse) {
+        return compressed ? positions.size() : sparse.size();
+    }
+    return index.count();
+}
 
-    if (find_result == idxmap.end()) {
+auto category_internals::get_pos_by_index(int idx) const -> size_t
+{
+    if (idx < 0 or types::int2size_t(idx) >= positions.size()) {
         throw std::runtime_error(fmt::format("Index {} not found in the map.", idx));
     }
 
-    return find_result->first;
+    return positions[types::int2size_t(idx)];
+}
+
+auto category_internals::position_of(size_t idx) const -> size_t
+{
+    if (compressed) {
+        return get_pos_by_index(types::size_t2int(idx));
+    }
+
+    if (mode == storage_mode::sparse) {
+        const auto keys = sparse.keys();
+        if (idx >= keys.size()) {
+            throw std::runtime_error(fmt::format("Index {} not found in the map.", idx));
+        }
+        return keys[idx];
+    }
+
+    return idx;
+}
+
+auto category_internals::filled_positions() -> std::span<const size_t>
+{
+    if (!compressed) {
+        index.collect(positions);
+    }
+
+    return positions;
+}
+
+auto category_internals::decode_locators() -> std::span<const size_t>
+{
+    locators.resize(positions.size() * dim);
+
+    auto loc_it = locators.begin();
+    for (auto pos : positions) {
+        for (auto val : offsets) {
+            *loc_it++ = pos / val;
+            pos %= val;
+        }
+    }
+
+    return locators;
+}
+
+auto category_internals::memory_usage() const -> size_t
+{
+    const auto vectors = positions.capacity() + slots.capacity() + locators.capacity() + batch.capacity() +
+                         batch_slots.capacity() + sizes.capacity() + offsets.capacity();
+    return index.memory_usage() + sparse.memory_usage() + (vectors * sizeof(size_t));
 }
 
 /**
@@ -118,29 +244,107 @@ auto category_internals::get_pos_by_index(int idx) -> size_t
 auto category_internals::clear() -> void
 {
     compressed = false;
-    idxmap.clear();
+    index.clear();
+    sparse.clear();
+    positions.clear();
+    slots.clear();
+    batch.clear();
 }
 
 auto category_internals::compress() -> void
 {
-    auto index = 0;
-    for (auto& iter : idxmap) {
-        iter.second = index++;
+    if (mode == storage_mode::sparse) {
+        // Order the slots by position, so that compressed objects follow the same order as in dense storage.
+        const auto keys = sparse.keys();
+        slots.resize(keys.size());
+        std::iota(slots.begin(), slots.end(), size_t {0});
+        std::ranges::sort(slots, std::less {}, [keys](size_t slot) { return keys[slot]; });
+
+        positions.resize(keys.size());
+        std::ranges::transform(slots, positions.begin(), [keys](size_t slot) { return keys[slot]; });
+    } else {
+        index.build_rank();
+        index.collect(positions);
     }
 
     compressed = true;
 }
 
+auto category_internals::restore_index() -> void
+{
+    if (mode == storage_mode::sparse) {
+        return;
+    }
+
+    index.rebuild(data_size, compressed ? std::span<const size_t>(positions) : std::span<const size_t>());
+}
+
+/**
+ * The occupancy bits are not streamed. After reading, they are rebuilt from the compressed positions, so that the
+ * category read from file can be accessed by locators.
+ */
+void category_internals::Streamer(TBuffer& R__b)
+{
+    if (R__b.IsReading()) {
+        R__b.ReadClassBuffer(category_internals::Class(), this);
+        restore_index();
+    } else {
+        R__b.WriteClassBuffer(category_internals::Class(), this);
+    }
+}
+
 }  // namespace details
 
-category::category(TClass* tclass, std::initializer_list<size_t> sizes, bool simulation)
+namespace
+{
+
+/// Initial number of slots of the sparse storage array
+constexpr Int_t sparse_initial_slots {64};
+
+/**
+ * Exposes the protected internals of TClonesArray, so that the category can clear and compress only the slots it
+ * knows are filled, instead of walking over the whole preallocated array.
+ */
+struct clones_access : TClonesArray
+{
+    static auto keep(TClonesArray* array) -> TObject** { return (array->*(&clones_access::fKeep))->GetObjectRef(); }
+
+    static auto last(TClonesArray* array) -> Int_t& { return array->*(&clones_access::fLast); }
+
+    static auto kept(TClonesArray* array, Int_t idx) -> bool
+    {
+        const auto* keep = array->*(&clones_access::fKeep);
+        return idx < keep->GetSize() and keep->UncheckedAt(idx) != nullptr;
+    }
+};
+
+/// Same as TClonesArray::Clear("C") does for each object
+auto reset_object(TObject* obj) -> void
+{
+    obj->Clear("");
+    obj->ResetBit(TObject::kHasUUID);
+    obj->ResetBit(TObject::kIsReferenced);
+    obj->SetUniqueID(0);
+}
+
+}  // namespace
+
+category::category(TClass* tclass, std::span<const size_t> sizes, bool simulation, storage_mode mode)
 {
     spdlog::debug("Construct category {} with class {} with sizes {}", header.name, tclass->GetName(), sizes);
     header.clear();
-    details::setup_header(header, tclass->GetName(), sizes, simulation);
-    data = new TClonesArray(tclass, types::size_t2int(header.data_size));
-
-    spdlog::info("    -> Category {:s} created with linear size of {:d}", tclass->GetName(), header.data_size);
+    details::setup_header(header, tclass->GetName(), sizes, simulation, mode);
+
+    if (mode == storage_mode::sparse) {
+        // The array expands on demand when slots are taken
+        data = new TClonesArray(tclass, sparse_initial_slots);
+        spdlog::info("    -> Category {:s} created with sparse storage of linear size {:d}",
+                     tclass->GetName(),
+                     header.data_size);
+    } else {
+        data = new TClonesArray(tclass, types::size_t2int(header.data_size));
+        spdlog::info("    -> Category {:s} created with linear size of {:d}", tclass->GetName(), header.data_size);
+    }
     header.writable = true;
 }
 
@@ -200,9 +404,31 @@ auto category::print() const -> void
     fmt::print("  {} objects in the category\n", data->GetEntries());
 }
 
+auto category::memory_usage() const -> category_memory
+{
+    const auto capacity = types::int2size_t(data->GetSize());
+    const auto object_size = types::int2size_t(data->GetClass()->Size());
+
+    const auto* keep = clones_access::keep(data);
+    const auto constructed =
+        static_cast<size_t>(std::count_if(keep, keep + capacity, [](const TObject* obj) { return obj != nullptr; }));
+
+    category_memory mem;
+    // TClonesArray keeps two arrays of pointers, the slots and the constructed objects
+    mem.preallocated = (((2 * capacity) + scratch.capacity()) * sizeof(TObject*)) + header.memory_usage();
+    mem.in_use = header.size() * object_size;
+    mem.retained = constructed * object_size;
+    mem.payload = payload_arena ? payload_arena->capacity() : 0;
+
+    return mem;
+}
+
 /**
  * Compress the category to reduce size in the memnory. After compression it is
  * not possible to add new slots.
+ *
+ * The filled objects are moved to the front of the array in order of their positions. Only the filled slots are
+ * visited. An empty category is left uncompressed, it is equivalent for the stored content.
  */
 auto category::compress() -> void
 {
@@ -211,17 +437,114 @@ auto category::compress() -> void
         return;
     }
 
-    data->Compress();
+    // A category with no slot filled since the last clear stays open. It is not on the touch list, thus the category
+    // manager would not clear it and the next event could not fill it.
+    if (header.is_compressed() or !touched) {
+        return;
+    }
+
     header.compress();
+
+    auto* cont = data->GetObjectRef();
+    auto* keep = clones_access::keep(data);
+
+    if (header.is_sparse()) {
+        // All slots 0..n-1 are filled, the objects are permuted in order of their positions.
+        const auto old_slots = header.compressed_slots();
+        scratch.resize(old_slots.size());
+        std::ranges::transform(old_slots, scratch.begin(), [keep](size_t slot) { return keep[slot]; });
+        for (size_t idx = 0; idx < scratch.size(); ++idx) {
+            keep[idx] = scratch[idx];
+            cont[idx] = scratch[idx];
+        }
+
+        clones_access::last(data) = types::size_t2int(scratch.size()) - 1;
+        return;
+    }
+
+    const auto poss = header.compressed_slots();
+
+    // Positions are ascending and pos >= idx, thus each swap takes the object from a slot not visited yet.
+    for (size_t idx = 0; idx < poss.size(); ++idx) {
+        const auto pos = poss[idx];
+        if (pos == idx) {
+            continue;
+        }
+
+        assert(cont[idx] == nullptr);
+        cont[idx] = cont[pos];
+        cont[pos] = nullptr;
+        std::swap(keep[idx], keep[pos]);
+    }
+
+    clones_access::last(data) = types::size_t2int(poss.size()) - 1;
+}
+
+auto category::is_constructed(Int_t slot) const -> bool
+{
+    return clones_access::kept(data, slot);
 }
 
 /**
- * Clear all objects and call Clear() methods of the stored objects.
+ * Clear all objects and call Clear() methods of the stored objects. Only the filled slots are visited. The payload
+ * arena is released as a whole. In the recycling mode the slots are only marked free, the objects are reset when
+ * created again.
  */
 auto category::clear() -> void
 {
-    data->Clear("C");
+    auto* cont = data->GetObjectRef();
+
+    const auto clear_slot = [cont](size_t idx)
+    {
+        if (cont[idx] != nullptr) {
+            reset_object(cont[idx]);
+            cont[idx] = nullptr;
+        }
+    };
+
+    const auto free_slot = [cont](size_t idx) { cont[idx] = nullptr; };
+
+    // The payload of the objects is released together with the arena. The objects are destroyed before and default
+    // constructed again, thus the kept objects never refer to the released memory.
+    const auto release_slot = [cont, tclass = data->GetClass()](size_t idx)
+    {
+        if (cont[idx] != nullptr) {
+            tclass->Destructor(cont[idx], kTRUE);
+            tclass->New(cont[idx]);
+            cont[idx] = nullptr;
+        }
+    };
+
+    const auto for_each_filled = [&](const auto& slot_fn)
+    {
+        // Compressed and sparse objects occupy first slots of the array
+        if (header.is_compressed() or header.is_sparse()) {
+            for (size_t idx = 0; idx < header.size(); ++idx) {
+                slot_fn(idx);
+            }
+        } else {
+            std::ranges::for_each(header.filled_positions(), slot_fn);
+        }
+    };
+
+    if (payload_arena) {
+        for_each_filled(release_slot);
+    } else if (recycling and (header.is_compressed() or header.is_sparse())) {
+        std::fill_n(cont, header.size(), nullptr);
+    } else if (recycling) {
+        for_each_filled(free_slot);
+    } else {
+        for_each_filled(clear_slot);
+    }
+
+    clones_access::last(data) = -1;
+    data->Changed();
     header.clear();
+    touched = false;
+
+    if (payload_arena) {
+        payload_arena->reset();
+    }
 }
 
 }  // namespace spark
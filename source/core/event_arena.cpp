@@ -0,0 +1,64 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#include "spark/core/event_arena.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+/**
+ * \class event_arena
+\ingroup lib_core
+
+Per-event monotonic arena for the category payloads
+
+*/
+
+namespace spark::details
+{
+
+event_arena::event_arena(size_t initial_size)
+    : buffer {std::make_unique_for_overwrite<std::byte[]>(initial_size)}
+    , buffer_size {initial_size}
+{
+    pool.emplace(buffer.get(), buffer_size, &upstream);
+}
+
+auto event_arena::reset() -> void
+{
+    if (upstream.bytes == 0) {
+        pool->release();  // rewinds to the beginning of the buffer, O(1)
+        return;
+    }
+
+    // The event did not fit, grow the buffer to the high-water mark so the next one does.
+    const auto new_size = buffer_size + upstream.bytes;
+
+    pool.reset();
+    buffer = std::make_unique_for_overwrite<std::byte[]>(new_size);
+    buffer_size = new_size;
+    upstream.bytes = 0;
+    ++growths;
+
+    pool.emplace(buffer.get(), buffer_size, &upstream);
+}
+
+auto event_arena::counting_resource::do_allocate(size_t bytes_n, size_t alignment) -> void*
+{
+    bytes += bytes_n;
+    ++allocations;
+    return std::pmr::new_delete_resource()->allocate(bytes_n, alignment);
+}
+
+auto event_arena::counting_resource::do_deallocate(void* ptr, size_t bytes_n, size_t alignment) -> void
+{
+    std::pmr::new_delete_resource()->deallocate(ptr, bytes_n, alignment);
+}
+
+}  // namespace spark::details
@@ -0,0 +1,122 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#include "spark/core/occupancy_index.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <vector>
+
+/**
+ * \class occupancy_index
+\ingroup lib_core
+
+Bitmap of filled category slots with rank/select support
+
+*/
+
+namespace spark::details
+{
+
+auto occupancy_index::set(std::span<const size_t> poss) -> size_t
+{
+    const auto before = n_set;
+
+    for (auto pos : poss) {
+        auto& word = words[pos / word_bits];
+        const auto mask = word_t {1} << (pos % word_bits);
+        if (word == 0) {
+            touched.push_back(static_cast<uint32_t>(pos / word_bits));
+        }
+        n_set += static_cast<size_t>((word & mask) == 0);
+        word |= mask;
+    }
+
+    return n_set - before;
+}
+
+auto occupancy_index::select(size_t idx) const -> size_t
+{
+    if (idx >= n_set) {
+        return n_bits;
+    }
+
+    // Last touched word which has no more than idx set bits before it.
+    auto iter = std::upper_bound(
+        touched.cbegin(), touched.cend(), idx, [this](size_t val, uint32_t word_idx) { return val < ranks[word_idx]; });
+    const auto word_idx = size_t {*std::prev(iter)};
+
+    auto word = words[word_idx];
+    for (auto skip = idx - ranks[word_idx]; skip > 0; --skip) {
+        word &= word - 1;  // drop lowest set bit
+    }
+
+    return word_idx * word_bits + static_cast<size_t>(std::countr_zero(word));
+}
+
+/**
+ * Called after each entry is read. The storage is reallocated only when the number of words changes, otherwise only
+ * the words touched by the previous entry are cleared, thus the cost is proportional to the filled slots.
+ */
+auto occupancy_index::rebuild(size_t bits, std::span<const size_t> poss) -> void
+{
+    if (words.size() == (bits + word_bits - 1) / word_bits) {
+        n_bits = bits;
+        clear();
+    } else {
+        resize(bits);
+    }
+    set(poss);
+    build_rank();
+}
+
+auto occupancy_index::build_rank() -> void
+{
+    std::sort(touched.begin(), touched.end());
+
+    uint32_t total {0};
+    for (auto word_idx : touched) {
+        ranks[word_idx] = total;
+        total += static_cast<uint32_t>(std::popcount(words[word_idx]));
+    }
+}
+
+auto occupancy_index::collect(std::vector<size_t>& positions) const -> void
+{
+    positions.clear();
+
+    const auto collect_word = [&](size_t word_idx)
+    {
+        for (auto word = words[word_idx]; word != 0; word &= word - 1) {
+            positions.push_back(word_idx * word_bits + static_cast<size_t>(std::countr_zero(word)));
+        }
+    };
+
+    for (auto word_idx : touched) {
+        collect_word(word_idx);
+    }
+
+    if (!std::is_sorted(positions.begin(), positions.end())) {
+        std::sort(positions.begin(), positions.end());
+    }
+}
+
+auto occupancy_index::clear() -> void
+{
+    for (auto word_idx : touched) {
+        words[word_idx] = 0;
+    }
+    touched.clear();
+    n_set = 0;
+}
+
+}  // namespace spark::details
@@ -0,0 +1,103 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#include "spark/core/sparse_index.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+
+/**
+ * \class sparse_index
+\ingroup lib_core
+
+Hash index of the filled positions of sparse category
+
+*/
+
+namespace spark::details
+{
+
+auto sparse_index::bucket_of(size_t pos) const -> size_t
+{
+    // Fibonacci hashing, neighbouring positions land far from each other
+    return static_cast<size_t>((static_cast<uint64_t>(pos) * 0x9E3779B97F4A7C15ULL) >> 32U) & mask;
+}
+
+auto sparse_index::find(size_t pos) const -> int
+{
+    if (order.empty()) {
+        return -1;
+    }
+
+    for (auto bucket = bucket_of(pos);; bucket = (bucket + 1) & mask) {
+        const auto entry = table[bucket];
+        if (entry == 0) {
+            return -1;
+        }
+        if (order[entry - 1] == pos) {
+            return static_cast<int>(entry - 1);
+        }
+    }
+}
+
+auto sparse_index::insert(size_t pos) -> size_t
+{
+    // Keep load factor below 1/2
+    if ((order.size() + 1) * 2 > table.size()) {
+        rehash(std::max(initial_buckets, table.size() * 2));
+    }
+
+    auto bucket = bucket_of(pos);
+    for (; table[bucket] != 0; bucket = (bucket + 1) & mask) {
+        if (order[table[bucket] - 1] == pos) {
+            return table[bucket] - 1;
+        }
+    }
+
+    order.push_back(pos);
+    table[bucket] = static_cast<uint32_t>(order.size());
+    return order.size() - 1;
+}
+
+auto sparse_index::clear() -> void
+{
+    if (order.size() * 8 > table.size()) {
+        std::fill(table.begin(), table.end(), 0);
+    } else {
+        // Reverse order of insertion, so the probe chain of each position is still intact when it is removed.
+        for (auto pos : std::ranges::reverse_view(order)) {
+            auto bucket = bucket_of(pos);
+            while (order[table[bucket] - 1] != pos) {
+                bucket = (bucket + 1) & mask;
+            }
+            table[bucket] = 0;
+        }
+    }
+
+    order.clear();
+}
+
+auto sparse_index::rehash(size_t n_buckets) -> void
+{
+    n_buckets = std::bit_ceil(n_buckets);
+    table.assign(n_buckets, 0);
+    mask = n_buckets - 1;
+
+    for (size_t slot = 0; slot < order.size(); ++slot) {
+        auto bucket = bucket_of(order[slot]);
+        while (table[bucket] != 0) {
+            bucket = (bucket + 1) & mask;
+        }
+        table[bucket] = static_cast<uint32_t>(slot + 1);
+    }
+}
+
+}  // namespace spark::details
@@ -0,0 +1,28 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#include "spark/core/task.hpp"
+
+#include "spark/core/category_manager.hpp"
+
+#include <cstddef>
+
+namespace spark
+{
+
+auto task::execute_batch(size_t n_events) -> bool
+{
+    bool status = true;
+    for (size_t evt = 0; evt < n_events; ++evt) {
+        cat_mgr->use_buffer(evt);
+        status = execute() and status;
+    }
+    return status;
+}
+
+}  // namespace spark
@@ -12,7 +12,10 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <format>
+#include <memory>
 #include <ranges>
+#include <stdexcept>
 
 #include <spdlog/spdlog.h>
 
@@ -106,6 +109,17 @@ auto task_manager::execute_tasks() -> void
         { std::for_each(queue_pair.second.begin(), queue_pair.second.end(), [&](auto& task) { task->execute(); }); });
 }
 
+auto task_manager::execute_tasks_batch(size_t n_events) -> void
+{
+    std::ranges::for_each(tasks_queue,
+                          [&](auto& queue_pair)
+                          {
+                              std::for_each(queue_pair.second.begin(),
+                                            queue_pair.second.end(),
+                                            [&](auto& task) { task->execute_batch(n_events); });
+                          });
+}
+
 auto task_manager::deinit_tasks() -> void
 {
     std::ranges::for_each(
@@ -119,4 +133,29 @@ auto task_manager::init_unpackers() -> void
     std::ranges::for_each(unpackers, [&](auto& unpacker) { unpacker->init(); });
 }
 
+auto task_manager::replicate(category_manager* mgr) const -> std::unique_ptr<task_manager>
+{
+    auto replica = std::make_unique<task_manager>(mgr, db_mgr);
+
+    for (const auto& [hash, orig] : unique_tasks) {
+        auto copy = orig->replicate(mgr, db_mgr);
+        if (!copy) {
+            throw std::logic_error(std::format("Task {} does not support the parallel mode, see task::replicate()",
+                                               utils::cpp_demangle(orig->name.c_str()).get()));
+        }
+
+        copy->name = orig->name;
+        copy->own_hash = orig->own_hash;
+        copy->deps = orig->deps;
+        copy->queue_builder_id = orig->queue_builder_id;
+        copy->task_running_step_id = orig->task_running_step_id;
+        copy->has_children = orig->has_children;
+
+        replica->tasks_queue[copy->task_running_step_id].push_back(copy.get());
+        replica->unique_tasks.emplace(hash, std::move(copy));
+    }
+
+    return replica;
+}
+
 }  // namespace spark
@@ -0,0 +1,363 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#include "spark/core/writer_ntuple.hpp"
+
+#include "spark/spark_config.hpp"
+#include "spark/spark_export.hpp"
+
+#include "spark/core/category.hpp"
+#include "spark/core/category_manager.hpp"
+#include "spark/core/data_source.hpp"
+#include "spark/core/task_manager.hpp"
+#include "spark/spark.hpp"
+#include "spark/utils/bounded_queue.hpp"
+
+#include <ROOT/REntry.hxx>
+#include <ROOT/RField.hxx>
+#include <ROOT/RNTupleFillContext.hxx>
+#include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RNTupleParallelWriter.hxx>
+#include <ROOT/RNTupleWriteOptions.hxx>
+
+#include <TClass.h>
+#include <TFile.h>
+#include <TROOT.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <format>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include <indicators/color.hpp>
+#include <indicators/cursor_control.hpp>
+#include <indicators/font_style.hpp>
+#include <indicators/indeterminate_progress_bar.hpp>
+
+namespace spark::writer
+{
+
+ntuple::ntuple(sparksys* sprk, std::string_view ntuple_name, std::string_view file_name)
+    : spark_dep(sprk)
+    , output_file_name {file_name}
+    , output_ntuple_name {ntuple_name}
+{
+    spdlog::info("..:: Init RNTuple writer with ntuple={} file={}", ntuple_name, file_name);
+
+    output_file = std::make_unique<TFile>(output_file_name.c_str(), "RECREATE");
+
+    if (!output_file->IsOpen()) {
+        spdlog::critical("[Error] in spark: could not open file {}", output_file_name);
+    }
+
+    auto rnt_model = ROOT::RNTupleModel::CreateBare();
+
+    spark()->model().build_from_model(
+        [&](category_info& cinfo)
+        {
+            if (!cinfo.persistent) {
+                spdlog::info("    -> Skipping category {:s} as not persistent.", cinfo.name);
+                return;
+            }
+
+            if (!cinfo.ptr) {
+                spdlog::info("    -> Skipping category {:s} as not built.", cinfo.name);
+                return;
+            }
+
+            if (!cinfo.copy_objects) {
+                spdlog::info("    -> Skipping category {:s} as its class is not copyable or not known.", cinfo.name);
+                return;
+            }
+
+            const auto type_name = std::format("std::vector<{}>", cinfo.ptr->get_class()->GetName());
+            spdlog::info("    -> Add fields {:s} of {:s} and {:s}_pos.", cinfo.name, type_name, cinfo.name);
+
+            rnt_model->AddField(ROOT::RFieldBase::Create(std::string(cinfo.name), type_name).Unwrap());
+            rnt_model->AddField(
+                std::make_unique<ROOT::RField<std::vector<std::uint64_t>>>(std::format("{}_pos", cinfo.name)));
+            written.push_back(cinfo.cat_id);
+        });
+
+    writer = ROOT::Experimental::RNTupleParallelWriter::Append(
+        std::move(rnt_model), output_ntuple_name, *output_file, ROOT::RNTupleWriteOptions());
+}
+
+auto ntuple::make_context(category_manager& cat_mgr) -> output_context
+{
+    output_context ctx;
+    ctx.fill_context = writer->CreateFillContext();
+    ctx.entry = ctx.fill_context->CreateEntry();
+
+    cat_mgr.build_from_model(
+        [&](category_info& cinfo)
+        {
+            if (std::ranges::binary_search(written, cinfo.cat_id)) {
+                ctx.fields.push_back({ctx.entry->GetToken(cinfo.name),
+                                      ctx.entry->GetToken(std::format("{}_pos", cinfo.name)),
+                                      &cinfo.ptr,
+                                      cinfo.copy_objects});
+            }
+        });
+
+    return ctx;
+}
+
+auto ntuple::fill_entry(output_context& ctx) -> void
+{
+    for (const auto& fields : ctx.fields) {
+        auto* cat = *fields.cat;
+        fields.copy(cat, ctx.entry->GetPtr<void>(fields.objects).get());
+
+        auto& positions = *ctx.entry->GetPtr<std::vector<std::uint64_t>>(fields.positions);
+        positions.resize(cat->size());
+        for (size_t idx = 0; idx < positions.size(); ++idx) {
+            positions[idx] = cat->get_position(idx);
+        }
+    }
+
+    ctx.fill_context->Fill(*ctx.entry);
+}
+
+auto ntuple::process_data(uint64_t entries, bool /*show_progress_bar*/) -> void
+{
+    spdlog::info("Initialize model");
+
+    spark()->open();
+
+    auto pbar = indicators::IndeterminateProgressBar {
+        indicators::option::BarWidth {80},
+        indicators::option::PostfixText {"Processing events"},
+        indicators::option::ForegroundColor {indicators::Color::yellow},
+        indicators::option::FontStyles {std::vector<indicators::FontStyle> {indicators::FontStyle::bold}}};
+
+    // Hide cursor
+    indicators::show_console_cursor(/*show=*/false);
+
+    const uint64_t max_event_count = entries == 0 ? std::numeric_limits<uint64_t>::max() : entries;
+
+    spdlog::info("Processing {} events", entries == 0 ? "all possible" : std::to_string(max_event_count));
+
+    const auto show_progress = [&](uint64_t event)
+    {
+        if ((event + 1) % 1000 == 0) {
+            pbar.set_option(indicators::option::PostfixText {std::to_string(event + 1)});
+            pbar.print_progress();
+        }
+
+        if ((event + 1) % 10000 == 0) {
+            pbar.tick();
+        }
+    };
+
+    const auto event_count = n_workers > 1 ? process_parallel(max_event_count, show_progress)
+                                           : process_serial(max_event_count, show_progress);
+
+    pbar.mark_as_completed();
+
+    tasks().deinit_tasks();
+
+    // Show cursor
+    indicators::show_console_cursor(/*show=*/true);
+
+    // Destroying the writer commits the RNTuple
+    writer.reset();
+
+    spdlog::info("*** spark finished after {} events", event_count);
+
+    model().print_stats();
+}
+
+auto ntuple::read_event(uint64_t event) -> bool
+{
+    for (auto& source : spark()->sources()) {
+        source->set_current_event(event);
+        if (!source->read_current_event()) {
+            spdlog::info("Source could not read more events, finished at {}", event);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+auto ntuple::process_serial(uint64_t max_events, const std::function<void(uint64_t)>& progress) -> uint64_t
+{
+    if (model().get_batch() > 1) {
+        throw std::logic_error("RNTuple writer cannot be used in batch mode");
+    }
+
+    auto ctx = make_context(model());
+
+    uint64_t event_count {0};
+    for (; event_count < max_events; ++event_count) {
+        progress(event_count);
+
+        model().clear();
+
+        if (!read_event(event_count)) {
+            break;
+        }
+
+        tasks().execute_tasks();
+        model().compress();
+
+        fill_entry(ctx);
+    }
+
+    return event_count;
+}
+
+/**
+ * The sources fill the free buffers in a separate thread as in tree::process_parallel(). Each worker takes the ready
+ * buffers, runs its task replicas, compresses the categories and fills the buffer into its own fill context, then
+ * returns the buffer. Only the statistics are recorded under a lock. The first exception of any thread stops the loop
+ * and is rethrown.
+ */
+auto ntuple::process_parallel(uint64_t max_events, const std::function<void(uint64_t)>& progress) -> uint64_t
+{
+    if (model().get_batch() > 1) {
+        throw std::logic_error("Parallel event loop cannot be combined with batch mode");
+    }
+
+    const auto n_buffers = model().get_buffers();
+    if (n_buffers < n_workers) {
+        throw std::logic_error(std::format("Parallel event loop with {} workers needs at least {} event buffers, see "
+                                           "category_manager::set_buffers()",
+                                           n_workers,
+                                           n_workers));
+    }
+
+    // Categories are streamed concurrently by the workers
+    ROOT::EnableThreadSafety();
+
+    struct worker_context
+    {
+        std::unique_ptr<category_manager> cat_mgr;  ///< view of the model
+        std::unique_ptr<task_manager> task_mgr;     ///< task replicas
+        output_context output;                      ///< fill context of the worker
+    };
+
+    std::vector<worker_context> contexts;
+    contexts.reserve(n_workers);
+    for (size_t w = 0; w < n_workers; ++w) {
+        auto view = model().make_view();
+        auto replicas = tasks().replicate(view.get());
+        replicas->init_tasks();
+        auto output = make_context(*view);
+        contexts.push_back({std::move(view), std::move(replicas), std::move(output)});
+    }
+
+    utils::bounded_queue<size_t> free_buffers(n_buffers);
+    utils::bounded_queue<size_t> ready_buffers(n_buffers);
+    for (size_t buf = 0; buf < n_buffers; ++buf) {
+        free_buffers.push(buf);
+    }
+
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    const auto fail = [&]
+    {
+        {
+            std::lock_guard lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+        free_buffers.close();
+        ready_buffers.close();
+    };
+
+    auto reader = std::jthread(
+        [&]
+        {
+            try {
+                for (uint64_t event = 0; event < max_events; ++event) {
+                    auto buf = free_buffers.pop();
+                    if (!buf) {
+                        break;
+                    }
+
+                    progress(event);
+
+                    model().fill_buffer(*buf);
+                    model().clear_input();
+
+                    if (!read_event(event) or !ready_buffers.push(*buf)) {
+                        break;
+                    }
+                }
+            } catch (...) {
+                fail();
+            }
+            ready_buffers.close();
+        });
+
+    std::atomic<uint64_t> event_count {0};
+    std::mutex stats_mutex;
+
+    std::vector<std::jthread> workers;
+    workers.reserve(n_workers);
+    for (auto& ctx : contexts) {
+        workers.emplace_back(
+            [&]
+            {
+                try {
+                    while (auto buf = ready_buffers.pop()) {
+                        ctx.cat_mgr->use_buffer(*buf);
+                        ctx.task_mgr->execute_tasks();
+                        model().compress_buffer(*buf);
+
+                        {
+                            std::lock_guard lock(stats_mutex);
+                            model().record_buffer(*buf);
+                        }
+
+                        fill_entry(ctx.output);
+                        ++event_count;
+
+                        free_buffers.push(*buf);
+                    }
+                } catch (...) {
+                    fail();
+                }
+            });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    free_buffers.close();
+    reader.join();
+
+    for (auto& ctx : contexts) {
+        ctx.task_mgr->deinit_tasks();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    return event_count;
+}
+
+}  // namespace spark::writer
@@ -13,6 +13,7 @@
 
 #include "spark/core/category.hpp"
 #include "spark/core/category_manager.hpp"
+#include "spark/core/column_category.hpp"
 #include "spark/core/data_source.hpp"
 #include "spark/core/root_file_header.hpp"
 #include "spark/core/spark_dep.hpp"
@@ -20,17 +21,34 @@
 #include "spark/core/types.hpp"
 #include "spark/parameters/database.hpp"
 #include "spark/spark.hpp"
+#include "spark/utils/bounded_queue.hpp"
 #include "spark/utils/conversions.hpp"
 
 #include <TChain.h>
 #include <TClass.h>
+#include <TBranch.h>
 #include <TFile.h>
+#include <TObjArray.h>
+#include <TParameter.h>
+#include <TROOT.h>
 #include <TTree.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -51,17 +69,34 @@ tree::tree(sparksys* sprk, std::string_view tree_name, std::string_view file_nam
 {
     spdlog::info("..:: Init Tree writer with tree={} file={}", tree_name, file_name);
 
-    // Create file and open it FIXME remove all below?
-    output_file = std::make_unique<TFile>(output_file_name.c_str(), "RECREATE");
+    // The file header is written by sparksys::open()
+    current_file_name = output_file_name;
+    open_file(current_file_name, model(), &category_info::output, output_file, output_tree, false);
+}
+
+auto tree::open_file(const std::string& file_name,
+                     category_manager& cat_mgr,
+                     category* category_info::* target,
+                     std::unique_ptr<TFile>& file,
+                     std::unique_ptr<TTree>& out_tree,
+                     bool with_header) -> void
+{
+    std::lock_guard lock(files_mutex);
+
+    file = std::make_unique<TFile>(file_name.c_str(), "RECREATE");
 
-    if (!output_file->IsOpen()) {
-        spdlog::critical("[Error] in spark: could not open file {}", output_file_name);
+    if (!file->IsOpen()) {
+        spdlog::critical("[Error] in spark: could not open file {}", file_name);
+    }
+
+    if (with_header) {
+        spark()->write_file_header();
     }
 
     // Create tree
-    output_tree = std::make_unique<TTree>(output_tree_name.c_str(), output_tree_name.c_str());
+    out_tree = std::make_unique<TTree>(output_tree_name.c_str(), output_tree_name.c_str());
 
-    spark()->model().build_from_model(
+    cat_mgr.build_from_model(
         [&](category_info& cinfo)
         {
             if (!cinfo.persistent) {
@@ -74,19 +109,171 @@ tree::tree(sparksys* sprk, std::string_view tree_name, std::string_view file_nam
                 return;
             }
 
-            spdlog::info("    -> Add branch {:s} pointing at {:p}.", cinfo.name, static_cast<void*>(&cinfo.ptr));
+            spdlog::info("    -> Add branch {:s} pointing at {:p}.", cinfo.name, static_cast<void*>(&(cinfo.*target)));
 
-            output_tree->Branch(cinfo.ptr->get_name(), &cinfo.ptr, 16000, 99);
+            out_tree->Branch(cinfo.ptr->get_name(), &(cinfo.*target), default_basket_size, 99);
 
             return;
         });
 }
 
+auto tree::close_file(const std::string& stream,
+                      uint64_t first_entry,
+                      std::unique_ptr<TFile>& file,
+                      std::unique_ptr<TTree>& out_tree) -> void
+{
+    std::lock_guard lock(files_mutex);
+
+    file->cd();
+    out_tree->Write();
+    manifest.push_back({file->GetName(), stream, first_entry, static_cast<uint64_t>(out_tree->GetEntries())});
+
+    // The tree is owned by us, it must leave the file before the file is closed
+    out_tree.reset();
+    file->Close();
+    file.reset();
+}
+
+auto tree::file_full(TFile* file, TTree* out_tree) const -> bool
+{
+    return (rotation.max_events > 0 and static_cast<uint64_t>(out_tree->GetEntries()) >= rotation.max_events)
+        or (rotation.max_bytes > 0 and static_cast<uint64_t>(file->GetEND()) >= rotation.max_bytes);
+}
+
+auto tree::rotate() -> void
+{
+    const auto entries = static_cast<uint64_t>(output_tree->GetEntries());
+    close_file("main", file_first_entry, output_file, output_tree);
+
+    file_first_entry += entries;
+    current_file_name = rotated_name(output_file_name, ++file_index);
+    spdlog::info("Output continues in {} from entry {}", current_file_name, file_first_entry);
+
+    open_file(current_file_name, model(), &category_info::output, output_file, output_tree, true);
+    for (auto* cols : columns) {
+        cols->make_branches(output_tree.get());
+    }
+
+    if (layout_enabled) {
+        layout_pending = true;
+        output_tree->SetAutoFlush(0);
+    }
+}
+
+auto tree::rotated_name(const std::string& base, size_t index) -> std::string
+{
+    return index == 0 ? base : suffixed_name(base, std::to_string(index));
+}
+
+auto tree::suffixed_name(const std::string& base, std::string_view suffix) -> std::string
+{
+    const auto path = std::filesystem::path(base);
+    const auto name = std::format("{}_{}{}", path.stem().string(), suffix, path.extension().string());
+    return (path.parent_path() / name).string();
+}
+
+auto tree::write_manifest() const -> void
+{
+    const auto manifest_name = std::filesystem::path(output_file_name).replace_extension(".manifest");
+
+    std::ofstream out(manifest_name);
+    if (!out) {
+        spdlog::error("Could not write manifest {}", manifest_name.string());
+        return;
+    }
+
+    out << "# file stream first_entry entries\n";
+    for (const auto& entry : manifest) {
+        out << std::format("{} {} {} {}\n", entry.file, entry.stream, entry.first_entry, entry.entries);
+    }
+
+    spdlog::info("Manifest of {} output files written to {}", manifest.size(), manifest_name.string());
+}
+
+auto tree::add_columns(column_store& cols) -> void
+{
+    spdlog::info("    -> Add columns {:p}.", static_cast<void*>(&cols));
+
+    cols.make_branches(output_tree.get());
+    columns.push_back(&cols);
+}
+
+auto tree::setup_pass_through(TChain* input, std::span<const std::string> names) -> void
+{
+    if (pass_tree) {
+        throw std::logic_error("Pass-through categories are already set");
+    }
+
+    // Own chain over the same files, thus the branch statuses of the reader are not affected
+    pass_input = std::make_unique<TChain>(input->GetName());
+    pass_input->Add(input);
+    pass_input->SetBranchStatus("*", 0);
+
+    for (const auto& name : names) {
+        if (output_tree->GetBranch(name.c_str())) {
+            throw std::logic_error(
+                std::format("Category {} is written by the tasks and cannot be passed through", name));
+        }
+        if (!pass_input->GetBranch(name.c_str())) {
+            throw std::runtime_error(std::format("Category {} not found in the input tree {}", name, input->GetName()));
+        }
+
+        spdlog::info("    -> Pass-through branch {:s}.", name);
+        pass_input->SetBranchStatus(name.c_str(), 1);
+    }
+
+    pass_input->LoadTree(0);
+
+    output_file->cd();
+    pass_tree.reset(pass_input->CloneTree(0));
+    const auto pass_name = output_tree_name + "_pass";
+    pass_tree->SetName(pass_name.c_str());
+    pass_tree->SetTitle(pass_name.c_str());
+
+    output_tree->AddFriend(pass_tree.get());
+}
+
+/**
+ * With all input entries processed, the TTreeCloner copies the compressed baskets as they are. Otherwise only the
+ * first entries are needed and the baskets must be split, thus the regular copy is used.
+ */
+auto tree::copy_pass_through(uint64_t events) -> void
+{
+    if (!pass_tree) {
+        return;
+    }
+
+    const auto n_events = static_cast<Long64_t>(events);
+    const auto fast = n_events >= pass_input->GetEntries();
+    if (!fast) {
+        spdlog::warn("Only {} of {} input entries processed, pass-through categories are copied without fast cloning",
+                     n_events,
+                     pass_input->GetEntries());
+    }
+
+    output_file->cd();
+    pass_tree->CopyEntries(pass_input.get(), fast ? -1 : n_events, fast ? "fast" : "");
+    pass_tree->Write();
+
+    if (pass_tree->GetEntries() != output_tree->GetEntries()) {
+        spdlog::warn("Pass-through tree has {} entries, output tree has {}",
+                     pass_tree->GetEntries(),
+                     output_tree->GetEntries());
+    }
+}
+
 auto tree::process_data(uint64_t entries, bool /*show_progress_bar*/) -> void
 {
     spdlog::info("Initialize model");
     // init_branches(); FIXME
 
+    const bool independent = n_workers > 1 and workers_order == output_order::independent;
+    if (pass_tree and (rotating() or independent)) {
+        throw std::logic_error("Pass-through categories cannot be used with rotated or independent output files");
+    }
+
+    manifest.clear();
+
     spark()->open();
 
     auto pbar = indicators::IndeterminateProgressBar {
@@ -109,45 +296,44 @@ auto tree::process_data(uint64_t entries, bool /*show_progress_bar*/) -> void
     spdlog::info("Processing {} events", entries == 0 ? "all possible" : std::to_string(max_event_count));
     // spdlog::info("Processing {} events", max_event_count);
 
-    for (; event_count < max_event_count; ++event_count) {
-        if ((event_count + 1) % 1000 == 0) {
+    const auto show_progress = [&](uint64_t event)
+    {
+        if ((event + 1) % 1000 == 0) {
             // Show iteration as postfix text
             // pbar.set_option(
             //     indicators::option::PostfixText {std::to_string(event_count) + "/" +
             //     std::to_string(n_events.value())});
 
-            pbar.set_option(indicators::option::PostfixText {std::to_string(event_count + 1)});
+            pbar.set_option(indicators::option::PostfixText {std::to_string(event + 1)});
             pbar.print_progress();
         }
 
-        if ((event_count + 1) % 10000 == 0) {
+        if ((event + 1) % 10000 == 0) {
             pbar.tick();
         }
+    };
 
-        model().clear();
+    if (n_workers > 1) {
+        event_count = process_parallel(max_event_count, show_progress);
+    } else if (model().get_batch() > 1) {
+        event_count = process_batched(max_event_count, show_progress);
+    } else if (model().get_buffers() > 1 or output_depth > 0) {
+        event_count = process_buffered(max_event_count, show_progress);
+    } else {
+        for (; event_count < max_event_count; ++event_count) {
+            show_progress(event_count);
 
-        bool flag = false;
+            model().clear();
+            std::ranges::for_each(columns, [](auto* cols) { cols->clear(); });
 
-        // get_entry(event_count);  // TODO do we need this? FIXME
+            // get_entry(event_count);  // TODO do we need this? FIXME
 
-        for (auto& source : spark()->sources()) {
-            source->set_current_event(event_count);
-            flag = source->read_current_event();
-            if (!flag) {
-                spdlog::info("Source could not read more events, finished at {}", event_count);
+            if (!read_event(event_count)) {
                 break;
             }
-        }
 
-        if (!flag) {
-            spdlog::info("Flag not valid, finished at {}", event_count);
-            break;
+            fill_event();
         }
-
-        tasks().execute_tasks();
-
-        model().compress();
-        output_tree->Fill();
     }
 
     pbar.mark_as_completed();
@@ -160,7 +346,550 @@ auto tree::process_data(uint64_t entries, bool /*show_progress_bar*/) -> void
     output_file->cd();
     output_tree->Write();
 
+    copy_pass_through(event_count);
+
+    if (rotating() or independent) {
+        if (!independent) {
+            manifest.push_back(
+                {current_file_name, "main", file_first_entry, static_cast<uint64_t>(output_tree->GetEntries())});
+        }
+        write_manifest();
+    }
+
     spdlog::info("*** spark finished after {} events", event_count);
+
+    model().print_stats();
+}
+
+auto tree::read_event(uint64_t event) -> bool
+{
+    bool flag = false;
+
+    for (auto& source : spark()->sources()) {
+        source->set_current_event(event);
+        flag = source->read_current_event();
+        if (!flag) {
+            spdlog::info("Source could not read more events, finished at {}", event);
+            break;
+        }
+    }
+
+    if (!flag) {
+        spdlog::info("Flag not valid, finished at {}", event);
+    }
+
+    return flag;
+}
+
+auto tree::fill_event() -> void
+{
+    tasks().execute_tasks();
+
+    model().compress();
+    fill_output();
+}
+
+auto tree::fill_output() -> void
+{
+    if (rotating() and file_full(output_file.get(), output_tree.get())) {
+        rotate();
+    }
+
+    output_tree->Fill();
+
+    if (layout_pending and static_cast<uint64_t>(output_tree->GetEntries()) >= layout.warmup_events) {
+        apply_layout();
+    }
+}
+
+auto tree::set_layout(const layout_policy& policy) -> void
+{
+    if (policy.min_basket == 0 or policy.min_basket > policy.max_basket) {
+        throw std::invalid_argument("Basket size limits must satisfy 0 < min_basket <= max_basket");
+    }
+
+    layout = policy;
+    layout_enabled = true;
+    layout_pending = true;
+    output_tree->SetAutoFlush(0);
+}
+
+/**
+ * The warm-up baskets are flushed first, thus the total bytes of each branch cover all warm-up events. The baskets
+ * sized for one cluster are flushed together at the cluster boundaries, so each cluster can be read independently
+ * with a single basket read per branch.
+ */
+auto tree::apply_layout() -> void
+{
+    layout_pending = false;
+
+    output_file->cd();
+    output_tree->FlushBaskets();
+
+    const auto entries = output_tree->GetEntries();
+    const auto bytes_per_event = std::max<Long64_t>(output_tree->GetTotBytes() / entries, 1);
+    const auto cluster_entries = std::max<Long64_t>(static_cast<Long64_t>(layout.cluster_bytes) / bytes_per_event, 1);
+
+    auto* info = output_tree->GetUserInfo();
+    info->Add(new TParameter<Long64_t>("layout.cluster_entries", cluster_entries));
+
+    // Each branch level is sized and recorded from its own bytes, the sub-branches are visited separately
+    const std::function<void(TObjArray*)> set_baskets = [&](TObjArray* branches)
+    {
+        for (auto* obj : *branches) {
+            auto* branch = static_cast<TBranch*>(obj);
+            const auto branch_bytes = branch->GetTotBytes() / entries;
+            const auto basket = std::clamp<Long64_t>(branch_bytes * cluster_entries,
+                                                     static_cast<Long64_t>(layout.min_basket),
+                                                     static_cast<Long64_t>(layout.max_basket));
+            branch->SetBasketSize(static_cast<Int_t>(basket));
+
+            info->Add(new TParameter<Long64_t>(std::format("layout.{}.bytes_per_event", branch->GetName()).c_str(),
+                                               branch_bytes));
+            info->Add(new TParameter<Long64_t>(std::format("layout.{}.basket_size", branch->GetName()).c_str(),
+                                               branch->GetBasketSize()));
+            spdlog::debug("    -> Layout of {:s}: {} bytes per event, basket of {} bytes",
+                          branch->GetName(),
+                          branch_bytes,
+                          branch->GetBasketSize());
+
+            set_baskets(branch->GetListOfBranches());
+        }
+    };
+    set_baskets(output_tree->GetListOfBranches());
+
+    output_tree->SetAutoFlush(cluster_entries);
+
+    spdlog::info("Output layout after {} events: {} bytes per event, clusters of {} events",
+                 entries,
+                 bytes_per_event,
+                 cluster_entries);
+}
+
+auto tree::print_stalls() const -> void
+{
+    using seconds = std::chrono::duration<double>;
+
+    spdlog::info("Stalls: sources {:.3f} s, tasks waiting for input {:.3f} s, tasks waiting for output {:.3f} s, "
+                 "output idle {:.3f} s",
+                 seconds(stalls.sources).count(),
+                 seconds(stalls.processing).count(),
+                 seconds(stalls.output_full).count(),
+                 seconds(stalls.output_idle).count());
+}
+
+/**
+ * The sources run in a separate thread and fill the free buffers ahead, while the current thread runs the tasks and
+ * fills the output with the ready ones. Each buffer is cleared by the reading thread just before it is refilled. With
+ * the asynchronous output the processed buffers are queued to the output thread, which fills them and returns them to
+ * the sources.
+ */
+auto tree::process_buffered(uint64_t max_events, const std::function<void(uint64_t)>& progress) -> uint64_t
+{
+    // The sources read the events and the asynchronous output fills the tree in separate threads
+    ROOT::EnableThreadSafety();
+
+    const auto n_buffers = model().get_buffers();
+    const bool async_output = output_depth > 0;
+
+    if (async_output and n_buffers < 2) {
+        throw std::logic_error(
+            "Asynchronous output needs at least 2 event buffers, see category_manager::set_buffers()");
+    }
+
+    if (async_output and !columns.empty()) {
+        throw std::logic_error("Columnar outputs are filled per event and cannot be used with asynchronous output");
+    }
+
+    utils::bounded_queue<size_t> free_buffers(n_buffers);
+    utils::bounded_queue<size_t> ready_buffers(n_buffers);
+    utils::bounded_queue<size_t> output_buffers(std::max<size_t>(output_depth, 1));
+    for (size_t buf = 0; buf < n_buffers; ++buf) {
+        free_buffers.push(buf);
+    }
+
+    std::exception_ptr reader_error;
+    std::exception_ptr output_error;
+
+    auto reader = std::jthread(
+        [&]
+        {
+            try {
+                for (uint64_t event = 0; event < max_events; ++event) {
+                    auto buf = free_buffers.pop();
+                    if (!buf) {
+                        break;
+                    }
+
+                    model().fill_buffer(*buf);
+                    model().clear_input();
+
+                    if (!read_event(event)) {
+                        break;
+                    }
+
+                    ready_buffers.push(*buf);
+                }
+            } catch (...) {
+                reader_error = std::current_exception();
+            }
+            ready_buffers.close();
+        });
+
+    std::jthread output;
+    if (async_output) {
+        output = std::jthread(
+            [&]
+            {
+                try {
+                    while (auto buf = output_buffers.pop()) {
+                        model().write_buffer(*buf);
+                        fill_output();
+                        free_buffers.push(*buf);
+                    }
+                } catch (...) {
+                    output_error = std::current_exception();
+                }
+                output_buffers.close();
+                free_buffers.close();
+            });
+    }
+
+    uint64_t event_count {0};
+
+    try {
+        while (auto buf = ready_buffers.pop()) {
+            progress(event_count);
+
+            model().use_buffer(*buf);
+
+            if (async_output) {
+                tasks().execute_tasks();
+                model().compress();
+
+                if (!output_buffers.push(*buf)) {
+                    break;
+                }
+            } else {
+                std::ranges::for_each(columns, [](auto* cols) { cols->clear(); });
+
+                model().write_buffer(*buf);
+                fill_event();
+
+                free_buffers.push(*buf);
+            }
+            ++event_count;
+        }
+    } catch (...) {
+        output_buffers.close();
+        free_buffers.close();
+        throw;
+    }
+
+    output_buffers.close();
+    if (output.joinable()) {
+        output.join();
+    }
+    free_buffers.close();
+    reader.join();
+
+    stalls = {
+        .sources = free_buffers.pop_stall(),
+        .processing = ready_buffers.pop_stall(),
+        .output_full = output_buffers.push_stall(),
+        .output_idle = output_buffers.pop_stall(),
+    };
+    print_stalls();
+
+    if (reader_error) {
+        std::rethrow_exception(reader_error);
+    }
+
+    if (output_error) {
+        std::rethrow_exception(output_error);
+    }
+
+    return event_count;
+}
+
+/**
+ * The events of the batch are read one by one into the event buffers, then the tasks, compression and clearing run
+ * once per batch. Only the Fill() is called per event.
+ */
+auto tree::process_batched(uint64_t max_events, const std::function<void(uint64_t)>& progress) -> uint64_t
+{
+    if (!columns.empty()) {
+        throw std::logic_error("Columnar outputs are filled per event and cannot be used in batch mode");
+    }
+
+    if (output_depth > 0) {
+        throw std::logic_error("Asynchronous output cannot be combined with batch mode");
+    }
+
+    const auto batch_size = model().get_batch();
+
+    uint64_t event_count {0};
+    bool more_events = true;
+
+    while (more_events and event_count < max_events) {
+        model().clear_batch();
+
+        size_t n_events {0};
+        for (; n_events < batch_size and event_count + n_events < max_events; ++n_events) {
+            model().fill_buffer(n_events);
+            if (!read_event(event_count + n_events)) {
+                more_events = false;
+                break;
+            }
+        }
+
+        if (n_events == 0) {
+            break;
+        }
+
+        model().set_batch_events(n_events);
+        tasks().execute_tasks_batch(n_events);
+        model().compress_batch();
+
+        for (size_t evt = 0; evt < n_events; ++evt, ++event_count) {
+            progress(event_count);
+            model().write_buffer(evt);
+            fill_output();
+        }
+    }
+
+    return event_count;
+}
+
+/**
+ * The sources fill the free buffers in a separate thread as in process_buffered(). Each worker takes the ready buffers,
+ * selects them in its own view of the model, runs its task replicas and compresses the categories. The calling thread
+ * records the statistics, fills the output and returns the buffers, in the ordered mode the events completed ahead of
+ * their turn wait in the buffers. In the independent mode the workers fill their own files instead and the calling
+ * thread only waits. The first exception of any thread stops the loop and is rethrown.
+ */
+auto tree::process_parallel(uint64_t max_events, const std::function<void(uint64_t)>& progress) -> uint64_t
+{
+    // The sources and the tasks run in separate threads, in the independent mode also the output
+    ROOT::EnableThreadSafety();
+
+    if (model().get_batch() > 1) {
+        throw std::logic_error("Parallel event loop cannot be combined with batch mode");
+    }
+
+    if (!columns.empty()) {
+        throw std::logic_error("Columnar outputs are filled per event and cannot be used in parallel mode");
+    }
+
+    const auto n_buffers = model().get_buffers();
+    if (n_buffers < n_workers) {
+        throw std::logic_error(std::format("Parallel event loop with {} workers needs at least {} event buffers, see "
+                                           "category_manager::set_buffers()",
+                                           n_workers,
+                                           n_workers));
+    }
+
+    struct worker_context
+    {
+        std::unique_ptr<category_manager> cat_mgr;  ///< view of the model
+        std::unique_ptr<task_manager> task_mgr;     ///< task replicas
+        std::string stream;                         ///< name of the output stream in the independent mode
+        std::string base_name;                      ///< name of the first output file in the independent mode
+        std::unique_ptr<TFile> file;                ///< current output file in the independent mode
+        std::unique_ptr<TTree> out_tree;            ///< current output tree in the independent mode
+        size_t file_index {0};                      ///< index of the current output file
+        uint64_t first_entry {0};                   ///< first entry of the current output file
+    };
+
+    const bool independent = workers_order == output_order::independent;
+
+    std::vector<worker_context> contexts;
+    contexts.reserve(n_workers);
+    for (size_t w = 0; w < n_workers; ++w) {
+        auto& ctx = contexts.emplace_back();
+        ctx.cat_mgr = model().make_view();
+        ctx.task_mgr = tasks().replicate(ctx.cat_mgr.get());
+        ctx.task_mgr->init_tasks();
+
+        if (independent) {
+            ctx.stream = std::format("w{}", w);
+            ctx.base_name = suffixed_name(output_file_name, ctx.stream);
+            open_file(ctx.base_name, *ctx.cat_mgr, &category_info::ptr, ctx.file, ctx.out_tree, true);
+        }
+    }
+
+    using event_slot = std::pair<uint64_t, size_t>;  // event number and its buffer
+
+    utils::bounded_queue<size_t> free_buffers(n_buffers);
+    utils::bounded_queue<event_slot> ready_events(n_buffers);
+    utils::bounded_queue<event_slot> done_events(n_buffers);
+    for (size_t buf = 0; buf < n_buffers; ++buf) {
+        free_buffers.push(buf);
+    }
+
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    const auto fail = [&]
+    {
+        {
+            std::lock_guard lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+        free_buffers.close();
+        ready_events.close();
+        done_events.close();
+    };
+
+    auto reader = std::jthread(
+        [&]
+        {
+            try {
+                for (uint64_t event = 0; event < max_events; ++event) {
+                    auto buf = free_buffers.pop();
+                    if (!buf) {
+                        break;
+                    }
+
+                    model().fill_buffer(*buf);
+                    model().clear_input();
+
+                    if (independent) {
+                        progress(event);
+                    }
+
+                    if (!read_event(event) or !ready_events.push({event, *buf})) {
+                        break;
+                    }
+                }
+            } catch (...) {
+                fail();
+            }
+            ready_events.close();
+        });
+
+    std::atomic<uint64_t> independent_count {0};
+    std::mutex stats_mutex;
+
+    // Fill the event into the own file of the worker, rotated as the main file
+    const auto write_own = [&](worker_context& ctx, size_t buf)
+    {
+        {
+            std::lock_guard lock(stats_mutex);
+            model().record_buffer(buf);
+        }
+
+        if (rotating() and file_full(ctx.file.get(), ctx.out_tree.get())) {
+            const auto entries = static_cast<uint64_t>(ctx.out_tree->GetEntries());
+            close_file(ctx.stream, ctx.first_entry, ctx.file, ctx.out_tree);
+            ctx.first_entry += entries;
+            open_file(rotated_name(ctx.base_name, ++ctx.file_index),
+                      *ctx.cat_mgr,
+                      &category_info::ptr,
+                      ctx.file,
+                      ctx.out_tree,
+                      true);
+        }
+
+        ctx.out_tree->Fill();
+        ++independent_count;
+
+        free_buffers.push(buf);
+    };
+
+    std::atomic<size_t> running {n_workers};
+    std::vector<std::jthread> workers;
+    workers.reserve(n_workers);
+    for (auto& ctx : contexts) {
+        workers.emplace_back(
+            [&]
+            {
+                try {
+                    while (auto item = ready_events.pop()) {
+                        ctx.cat_mgr->use_buffer(item->second);
+                        ctx.task_mgr->execute_tasks();
+                        model().compress_buffer(item->second);
+
+                        if (independent) {
+                            write_own(ctx, item->second);
+                            continue;
+                        }
+
+                        if (!done_events.push(*item)) {
+                            break;
+                        }
+                    }
+                } catch (...) {
+                    fail();
+                }
+
+                if (--running == 0) {
+                    done_events.close();
+                }
+            });
+    }
+
+    uint64_t event_count {0};
+    std::map<uint64_t, size_t> pending;
+
+    const auto write = [&](size_t buf)
+    {
+        progress(event_count);
+
+        model().write_buffer(buf);
+        model().record_buffer(buf);
+        fill_output();
+
+        free_buffers.push(buf);
+        ++event_count;
+    };
+
+    try {
+        while (auto item = done_events.pop()) {
+            if (workers_order == output_order::unordered) {
+                write(item->second);
+                continue;
+            }
+
+            pending.emplace(*item);
+            for (auto iter = pending.begin(); iter != pending.end() and iter->first == event_count;) {
+                write(iter->second);
+                iter = pending.erase(iter);
+            }
+        }
+    } catch (...) {
+        fail();
+    }
+
+    free_buffers.close();
+    ready_events.close();
+    reader.join();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (auto& ctx : contexts) {
+        ctx.task_mgr->deinit_tasks();
+        if (ctx.file) {
+            close_file(ctx.stream, ctx.first_entry, ctx.file, ctx.out_tree);
+        }
+    }
+
+    stalls = {
+        .sources = free_buffers.pop_stall(),
+        .processing = ready_events.pop_stall(),
+        .output_full = done_events.push_stall(),
+        .output_idle = done_events.pop_stall(),
+    };
+    print_stalls();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    return event_count + independent_count;
 }
 
 }  // namespace spark::writer
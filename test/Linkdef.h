@@ -20,6 +20,11 @@
 #pragma link C++ class Lookup1Lut+;
 #pragma link C++ class Tabular1Par+;
 
+#pragma link C++ class test_hit+;
+#pragma link C++ class test_other_hit+;
+#pragma link C++ class test_waveform+;
+#pragma link C++ class test_recycled_hit+;
+
 // clang-format on
 
 #endif
@@ -0,0 +1,44 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <spark/core/category.hpp>
+#include <spark/core/types.hpp>
+
+#include <cstddef>
+
+/**
+ * The canonical task loop: for each entry take its locator and object. The locator lookup must be O(1) so that whole
+ * event scales linearly with number of hits.
+ */
+static void BM_CategoryLocatorLoop(benchmark::State& state)
+{
+    const auto n_hits = static_cast<size_t>(state.range(0));
+
+    auto hdr = spark::details::category_internals();
+    spark::details::setup_header(hdr, "bench_cat", {16, 64, 64}, false);
+
+    for (auto _ : state) {
+        hdr.clear();
+        for (size_t i = 0; i < n_hits; ++i) {
+            const auto pos = (i * 7) % hdr.data_size;
+            hdr.set_map_index(pos, spark::types::size_t2int(pos));
+        }
+        hdr.compress();
+
+        for (size_t i = 0; i < hdr.size(); ++i) {
+            auto loc = hdr.pos2loc(hdr.get_pos_by_index(spark::types::size_t2int(i)));
+            benchmark::DoNotOptimize(loc);
+        }
+    }
+
+    state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_CategoryLocatorLoop)->RangeMultiplier(4)->Range(64, 10000)->Complexity(benchmark::oN);
@@ -0,0 +1,156 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <spark/core/category.hpp>
+#include <spark/core/category_manager.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <TObject.h>
+
+namespace
+{
+enum class bench_categories : std::uint8_t
+{
+};
+}  // namespace
+
+/**
+ * Event boundary cost: compress and clear of all categories, as done by the writer after each event. Arguments are
+ * number of categories, number of hits per category and number of threads (1 for serial mode).
+ */
+static void BM_CategoryManagerBoundary(benchmark::State& state)
+{
+    const auto n_cats = static_cast<size_t>(state.range(0));
+    const auto n_hits = static_cast<size_t>(state.range(1));
+    const auto n_threads = static_cast<size_t>(state.range(2));
+
+    auto mgr = spark::category_manager();
+    mgr.set_parallel(n_threads, 0);
+
+    std::vector<spark::category*> cats;
+    for (size_t i = 0; i < n_cats; ++i) {
+        const auto cat_id = static_cast<bench_categories>(i);
+        mgr.register_category(cat_id, "bench_cat" + std::to_string(i), {16, 64, 64}, false);
+        cats.push_back(mgr.build_category<TObject>(cat_id));
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (auto* cat : cats) {
+            for (size_t i = 0; i < n_hits; ++i) {
+                cat->make_object_at<TObject>((i * 7919) % (16 * 64 * 64));
+            }
+        }
+        state.ResumeTiming();
+
+        mgr.compress();
+        mgr.clear();
+    }
+
+    state.counters["categories"] = static_cast<double>(n_cats);
+    state.counters["per_category"] = benchmark::Counter(
+        static_cast<double>(n_cats), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+BENCHMARK(BM_CategoryManagerBoundary)
+    ->ArgsProduct({{4, 16, 32, 64}, {20, 500}, {1, 4}})
+    ->ArgNames({"categories", "hits", "threads"})
+    ->UseRealTime();
+
+/**
+ * Event boundary cost of sparse events: 64 categories are built, but only a few of them are filled in each event.
+ * Arguments are number of filled categories and number of hits per category.
+ */
+static void BM_CategoryManagerSparseEvent(benchmark::State& state)
+{
+    constexpr size_t n_cats = 64;
+    const auto n_filled = static_cast<size_t>(state.range(0));
+    const auto n_hits = static_cast<size_t>(state.range(1));
+
+    auto mgr = spark::category_manager();
+
+    std::vector<spark::category*> cats;
+    for (size_t i = 0; i < n_cats; ++i) {
+        const auto cat_id = static_cast<bench_categories>(i);
+        mgr.register_category(cat_id, "bench_cat" + std::to_string(i), {16, 64, 64}, false);
+        cats.push_back(mgr.build_category<TObject>(cat_id));
+    }
+
+    size_t event {0};
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (size_t j = 0; j < n_filled; ++j) {
+            auto* cat = cats[(event + j * 13) % n_cats];
+            for (size_t i = 0; i < n_hits; ++i) {
+                cat->make_object_at<TObject>((i * 7919) % (16 * 64 * 64));
+            }
+        }
+        ++event;
+        state.ResumeTiming();
+
+        mgr.compress();
+        mgr.clear();
+    }
+}
+
+BENCHMARK(BM_CategoryManagerSparseEvent)->ArgsProduct({{0, 1, 4, 64}, {20}})->ArgNames({"filled", "hits"});
+
+/**
+ * Cost of the event boundaries of small events (3 hits in 8 categories) per event, processed one by one (batch 1) or
+ * in batches. Argument is the batch size.
+ */
+static void BM_CategoryManagerBatch(benchmark::State& state)
+{
+    constexpr size_t n_cats = 8;
+    constexpr size_t n_hits = 3;
+    const auto batch_size = static_cast<size_t>(state.range(0));
+
+    auto mgr = spark::category_manager();
+    mgr.set_batch(batch_size);
+
+    for (size_t i = 0; i < n_cats; ++i) {
+        const auto cat_id = static_cast<bench_categories>(i);
+        mgr.register_category(cat_id, "bench_cat" + std::to_string(i), {16, 64}, false, spark::storage_mode::sparse);
+        mgr.build_category<TObject>(cat_id);
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (size_t evt = 0; evt < batch_size; ++evt) {
+            mgr.fill_buffer(evt);
+            for (size_t i = 0; i < n_cats; ++i) {
+                auto* cat = mgr.get_input_category(static_cast<bench_categories>(i));
+                for (size_t hit = 0; hit < n_hits; ++hit) {
+                    cat->make_object_at<TObject>(hit * 97);
+                }
+            }
+        }
+        state.ResumeTiming();
+
+        if (batch_size == 1) {
+            mgr.compress();
+            mgr.clear();
+        } else {
+            mgr.set_batch_events(batch_size);
+            mgr.compress_batch();
+            mgr.clear_batch();
+        }
+    }
+
+    state.counters["per_event"] = benchmark::Counter(static_cast<double>(batch_size),
+                                                     benchmark::Counter::kIsIterationInvariantRate
+                                                         | benchmark::Counter::kInvert);
+}
+
+BENCHMARK(BM_CategoryManagerBatch)->Arg(1)->Arg(8)->Arg(32)->ArgNames({"batch"});
@@ -0,0 +1,71 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#pragma once
+
+#include <spark/core/category.hpp>
+
+#include <memory_resource>
+#include <vector>
+
+#include <Rtypes.h>
+#include <TObject.h>
+
+struct test_hit : public TObject
+{
+    test_hit() = default;
+
+    int value {0};     ///<
+    float energy {0};  ///<
+
+    ClassDefOverride(test_hit, 1)
+};
+
+template<>
+inline constexpr bool spark::trivially_resettable<test_hit> = true;
+
+struct test_other_hit : public TObject
+{
+    test_other_hit() = default;
+
+    float value {0};  ///<
+
+    ClassDefOverride(test_other_hit, 1)
+};
+
+struct test_waveform : public TObject
+{
+    test_waveform() = default;
+
+    explicit test_waveform(std::pmr::memory_resource* mr)
+        : samples {mr}
+    {
+    }
+
+    std::pmr::vector<float> samples;  //!
+
+    ClassDefOverride(test_waveform, 1)
+};
+
+struct test_recycled_hit : public TObject
+{
+    test_recycled_hit() { ++constructed; }
+
+    auto reset() -> void
+    {
+        value = 0;
+        ++resets;
+    }
+
+    int value {0};  ///<
+
+    static inline int constructed {0};  //!
+    static inline int resets {0};       //!
+
+    ClassDefOverride(test_recycled_hit, 1)
+};
@@ -9,9 +9,21 @@
 #include <gtest/gtest.h>
 
 #include <spark/core/category.hpp>
+#include <spark/core/column_category.hpp>
+#include <spark/core/event_arena.hpp>
+#include <spark/core/sparse_index.hpp>
+#include <spark/core/static_category.hpp>
 #include <spark/core/types.hpp>
 
+#include "test_objects.hpp"
+
+#include <algorithm>
+#include <array>
+#include <execution>
+#include <ranges>
+
 #include <limits>
+#include <span>
 #include <stdexcept>
 
 using spark::types::LocatorContainer;
@@ -208,36 +220,498 @@ TEST(TestCategory, SetupSetup3Dim)
     ASSERT_EQ(hdr.pos2loc(39), (std::vector<size_t> {1, 4, 3}));
 }
 
+TEST(TestCategory, OccupancyIndex)
+{
+    auto idx = spark::details::occupancy_index();
+    idx.resize(200);
+
+    ASSERT_EQ(idx.capacity(), 200);
+    ASSERT_EQ(idx.count(), 0);
+
+    ASSERT_TRUE(idx.set(3));
+    ASSERT_TRUE(idx.set(64));
+    ASSERT_TRUE(idx.set(130));
+    ASSERT_TRUE(idx.set(199));
+    ASSERT_FALSE(idx.set(64));
+
+    ASSERT_EQ(idx.count(), 4);
+    ASSERT_TRUE(idx.test(130));
+    ASSERT_FALSE(idx.test(131));
+    ASSERT_FALSE(idx.test(1000));
+
+    idx.build_rank();
+
+    ASSERT_EQ(idx.rank(3), 0);
+    ASSERT_EQ(idx.rank(64), 1);
+    ASSERT_EQ(idx.rank(130), 2);
+    ASSERT_EQ(idx.rank(199), 3);
+
+    ASSERT_EQ(idx.select(0), 3);
+    ASSERT_EQ(idx.select(1), 64);
+    ASSERT_EQ(idx.select(2), 130);
+    ASSERT_EQ(idx.select(3), 199);
+    ASSERT_EQ(idx.select(4), 200);
+
+    idx.clear();
+    ASSERT_EQ(idx.count(), 0);
+    ASSERT_FALSE(idx.test(3));
+    ASSERT_FALSE(idx.test(199));
+
+    ASSERT_TRUE(idx.set(150));
+    ASSERT_TRUE(idx.set(5));
+
+    std::vector<size_t> positions;
+    idx.collect(positions);
+    ASSERT_EQ(positions, (std::vector<size_t> {5, 150}));
+
+    idx.build_rank();
+    ASSERT_EQ(idx.rank(150), 1);
+    ASSERT_EQ(idx.select(1), 150);
+
+    // Restore the bits from the positions, as after reading from a file
+    auto restored = spark::details::occupancy_index();
+    restored.rebuild(200, positions);
+
+    ASSERT_EQ(restored.capacity(), 200);
+    ASSERT_EQ(restored.count(), 2);
+    ASSERT_TRUE(restored.test(5));
+    ASSERT_FALSE(restored.test(6));
+    ASSERT_EQ(restored.rank(150), 1);
+    ASSERT_EQ(restored.select(0), 5);
+
+    // Next entry of the same size reuses the storage, the previous bits are cleared
+    const std::vector<size_t> next {7};
+    restored.rebuild(200, next);
+    ASSERT_EQ(restored.count(), 1);
+    ASSERT_FALSE(restored.test(5));
+    ASSERT_FALSE(restored.test(150));
+    ASSERT_TRUE(restored.test(7));
+    ASSERT_EQ(restored.rank(7), 0);
+
+    // Different size reallocates
+    restored.rebuild(1000, positions);
+    ASSERT_EQ(restored.capacity(), 1000);
+    ASSERT_EQ(restored.count(), 2);
+    ASSERT_FALSE(restored.test(7));
+    ASSERT_TRUE(restored.test(150));
+
+    restored.clear();
+    ASSERT_EQ(restored.count(), 0);
+    ASSERT_FALSE(restored.test(150));
+}
+
+TEST(TestCategory, MapIndex)
+{
+    auto hdr = spark::details::category_internals();
+    spark::details::setup_header(hdr, "test_cat", {2, 5, 40}, true);
+
+    ASSERT_EQ(hdr.get_map_index(hdr.loc2pos({0, 0, 0})), -1);
+
+    ASSERT_TRUE(hdr.set_map_index(hdr.loc2pos({1, 4, 39}), spark::types::size_t2int(hdr.loc2pos({1, 4, 39}))));
+    ASSERT_TRUE(hdr.set_map_index(hdr.loc2pos({0, 1, 2}), spark::types::size_t2int(hdr.loc2pos({0, 1, 2}))));
+    ASSERT_TRUE(hdr.set_map_index(hdr.loc2pos({1, 0, 0}), spark::types::size_t2int(hdr.loc2pos({1, 0, 0}))));
+
+    ASSERT_EQ(hdr.size(), 3);
+    ASSERT_EQ(hdr.get_map_index(hdr.loc2pos({0, 1, 2})), 42);
+    ASSERT_EQ(hdr.get_map_index(hdr.loc2pos({1, 0, 0})), 200);
+    ASSERT_EQ(hdr.get_map_index(hdr.loc2pos({0, 0, 0})), -1);
+
+    ASSERT_THROW(hdr.set_map_index(400, 400), std::out_of_range);
+
+    hdr.compress();
+
+    ASSERT_TRUE(hdr.is_compressed());
+    ASSERT_FALSE(hdr.set_map_index(0, 0));
+
+    ASSERT_EQ(hdr.get_map_index(hdr.loc2pos({0, 1, 2})), 0);
+    ASSERT_EQ(hdr.get_map_index(hdr.loc2pos({1, 0, 0})), 1);
+    ASSERT_EQ(hdr.get_map_index(hdr.loc2pos({1, 4, 39})), 2);
+    ASSERT_EQ(hdr.get_map_index(hdr.loc2pos({0, 0, 0})), -1);
+
+    ASSERT_EQ(hdr.get_pos_by_index(0), 42);
+    ASSERT_EQ(hdr.get_pos_by_index(1), 200);
+    ASSERT_EQ(hdr.get_pos_by_index(2), 399);
+    ASSERT_THROW(hdr.get_pos_by_index(3), std::runtime_error);
+
+    hdr.clear();
+
+    ASSERT_FALSE(hdr.is_compressed());
+    ASSERT_EQ(hdr.size(), 0);
+    ASSERT_EQ(hdr.get_map_index(hdr.loc2pos({0, 1, 2})), -1);
+}
+
+TEST(TestCategory, StaticCategoryShape)
+{
+    using cat3d = spark::static_category<TObject, 2, 5, 4>;
+
+    static_assert(cat3d::dim == 3);
+    static_assert(cat3d::data_size == 40);
+    static_assert(cat3d::offsets == std::array<size_t, 3> {20, 4, 1});
+    static_assert(cat3d::pos<0, 0, 0>() == 0);
+    static_assert(cat3d::pos<1, 4, 3>() == 39);
+    static_assert(cat3d::loc2pos({1, 2, 3}) == 31);
+    static_assert(cat3d::pos2loc(31) == cat3d::locator {1, 2, 3});
+
+    auto hdr = spark::details::category_internals();
+    spark::details::setup_header(hdr, "test_cat", {2, 5, 4}, true);
+
+    for (size_t pos = 0; pos < cat3d::data_size; ++pos) {
+        const auto loc = cat3d::pos2loc(pos);
+        ASSERT_EQ(cat3d::loc2pos(loc), pos);
+        ASSERT_EQ(hdr.loc2pos(std::vector<size_t> {loc[0], loc[1], loc[2]}), pos);
+    }
+
+    ASSERT_THROW(cat3d(nullptr), std::invalid_argument);
+}
+
 TEST(TestCategory, RangesCompatible)
 {
-    // static_assert(std::ranges::contiguous_range<spark::category>);
-    // static_assert(std::ranges::random_access_range<spark::category>);
-
-    // enum class TestCategory
-    // {
-    //     Test = 1
-    // };
-    //
-    // // FIXME iterates forever
-    // struct TestObject : public TObject
-    // {
-    //     int a = 0;
-    // };
-    //
-    // auto cat = spark::category(TClass::GetClass<TestObject>(), {10}, false);
-    //
-    // cat.get_next_slot<TestObject>()->a = 1;
-    // cat.get_next_slot<TestObject>()->a = 2;
-    // cat.get_next_slot<TestObject>()->a = 3;
-    //
-    // int counter {0};
-    // for (auto c_obj : cat) {
-    //     counter++;
-    //
-    //     spdlog::info("{} -> {}", (void*)c_obj, static_cast<TestObject*>(c_obj)->a);
-    //
-    //     if (counter == 20) break;
-    // }
-    //
-    // ASSERT_EQ(counter, 3);
+    static_assert(std::ranges::random_access_range<spark::category_view<test_hit>>);
+    static_assert(std::ranges::sized_range<spark::category_view<test_hit>>);
+    static_assert(std::ranges::borrowed_range<spark::category_view<test_hit>>);
+
+    auto cat = spark::category(TClass::GetClass<test_hit>(), {3, 4}, false);
+
+    cat.make_object_unsafe<test_hit>({2, 1})->value = 3;
+    cat.make_object_unsafe<test_hit>({0, 3})->value = 1;
+    cat.make_object_unsafe<test_hit>({1, 0})->value = 2;
+
+    auto view = cat.view<test_hit>();
+
+    ASSERT_EQ(view.size(), 3);
+
+    int counter {0};
+    for (auto [loc, obj] : view) {
+        counter++;
+        ASSERT_EQ(obj.value, counter);
+        ASSERT_EQ(std::vector<size_t>(loc.begin(), loc.end()), cat.get_locator(counter - 1));
+    }
+    ASSERT_EQ(counter, 3);
+
+    ASSERT_EQ(view[2].second.value, 3);
+    ASSERT_EQ(view[2].first[0], 2);
+    ASSERT_EQ(view[2].first[1], 1);
+
+    auto found = std::ranges::find_if(view, [](const auto& entry) { return entry.second.value == 2; });
+    ASSERT_EQ(found - view.begin(), 1);
+
+    std::ranges::for_each(view, [](auto entry) { entry.second.value *= 10; });
+    ASSERT_EQ(cat.get_object<test_hit>({1, 0})->value, 20);
+
+    // The elements are proxies, thus the parallel algorithms accept the view as an input range
+    std::for_each(std::execution::par, view.begin(), view.end(), [](auto entry) { entry.second.value += 1; });
+    ASSERT_EQ(cat.get_object<test_hit>({0, 3})->value, 11);
+    ASSERT_EQ(cat.get_object<test_hit>({1, 0})->value, 21);
+    ASSERT_EQ(cat.get_object<test_hit>({2, 1})->value, 31);
+
+    ASSERT_THROW(cat.view<test_other_hit>(), std::runtime_error);
+}
+
+TEST(TestCategory, AccessPolicy)
+{
+    using spark::policy::checked;
+    using spark::policy::unchecked;
+
+    auto hdr = spark::details::category_internals();
+    spark::details::setup_header(hdr, "test_cat", {3, 4}, false);
+
+    ASSERT_EQ(hdr.loc2pos<checked>({2, 3}), 11);
+    ASSERT_EQ(hdr.loc2pos<unchecked>({2, 3}), 11);
+
+    // Unchecked access aliases the out of range coordinate into another cell
+    ASSERT_EQ(hdr.loc2pos<unchecked>({0, 5}), hdr.loc2pos<unchecked>({1, 1}));
+    ASSERT_THROW(hdr.loc2pos<checked>({0, 5}), std::out_of_range);
+    ASSERT_THROW(hdr.loc2pos<checked>({3, 0}), std::out_of_range);
+    ASSERT_THROW(hdr.loc2pos<checked>({1}), std::runtime_error);
+    // The dimension is validated by both policies
+    ASSERT_THROW(hdr.loc2pos<unchecked>({1}), std::runtime_error);
+    ASSERT_THROW(hdr.loc2pos<unchecked>({1, 1, 1}), std::runtime_error);
+
+    auto cat = spark::category(TClass::GetClass<test_hit>(), {3, 4}, false);
+
+    auto* obj = cat.access<unchecked>().make_object_unsafe<test_hit>({0, 5});
+    ASSERT_EQ(cat.get_object<test_hit>({1, 1}), obj);
+    ASSERT_EQ(cat.access<checked>().get_object<test_hit>({1, 1}), obj);
+    ASSERT_THROW(cat.access<checked>().make_object_unsafe<test_hit>({0, 5}), std::out_of_range);
+
+    const std::vector<std::array<size_t, 2>> locs {{2, 0}, {2, 4}};
+    ASSERT_THROW(cat.access<checked>().make_objects<test_hit>(locs), std::out_of_range);
+    const std::vector<std::array<size_t, 3>> wrong_dim {{0, 0, 0}};
+    ASSERT_THROW(cat.access<unchecked>().make_objects<test_hit>(wrong_dim), std::runtime_error);
+    ASSERT_EQ(cat.get_entries(), 1);
+}
+
+TEST(TestCategory, ClearCompressFilledSlots)
+{
+    auto cat = spark::category(TClass::GetClass<test_hit>(), {10, 20, 30}, false);
+
+    cat.make_object_unsafe<test_hit>({9, 19, 29})->value = 3;
+    cat.make_object_unsafe<test_hit>({0, 0, 1})->value = 1;
+    auto* mid = cat.make_object_unsafe<test_hit>({4, 5, 6});
+    mid->value = 2;
+
+    cat.compress();
+    cat.compress();
+
+    ASSERT_EQ(cat.get_entries(), 3);
+    ASSERT_EQ(cat.get_object<test_hit>(0)->value, 1);
+    ASSERT_EQ(cat.get_object<test_hit>(1), mid);
+    ASSERT_EQ(cat.get_object<test_hit>(2)->value, 3);
+    ASSERT_EQ(cat.get_object<test_hit>({4, 5, 6}), mid);
+    ASSERT_EQ(cat.get_locator(2), (std::vector<size_t> {9, 19, 29}));
+
+    cat.clear();
+
+    ASSERT_EQ(cat.get_entries(), 0);
+    ASSERT_EQ(cat.get_object<test_hit>({4, 5, 6}), nullptr);
+
+    // Memory of the compressed objects is reused by next slots
+    auto* reused = cat.make_object_unsafe<test_hit>({0, 0, 1});
+    ASSERT_EQ(reused, mid);
+    ASSERT_EQ(reused->value, 0);
+
+    cat.make_object_unsafe<test_hit>({1, 0, 0});
+    cat.clear();
+    ASSERT_EQ(cat.get_entries(), 0);
+
+    cat.make_object_unsafe<test_hit>({2, 0, 0})->value = 7;
+    cat.compress();
+    ASSERT_EQ(cat.get_entries(), 1);
+    ASSERT_EQ(cat.get_object<test_hit>(0)->value, 7);
+}
+
+TEST(TestCategory, PayloadArena)
+{
+    auto arena = spark::details::event_arena(256);
+    ASSERT_EQ(arena.capacity(), 256);
+
+    {
+        std::pmr::vector<float> vec {arena.resource()};
+        vec.resize(10);
+        ASSERT_EQ(arena.heap_allocations(), 0);
+        vec.resize(1000);
+        ASSERT_GT(arena.heap_allocations(), 0);
+    }
+    arena.reset();
+    ASSERT_GT(arena.capacity(), 256 + 1000 * sizeof(float));
+
+    // Steady state: the buffer fits the whole event, no more heap allocations
+    const auto allocations = arena.heap_allocations();
+    for (int event = 0; event < 3; ++event) {
+        std::pmr::vector<float> vec {arena.resource()};
+        vec.resize(10);
+        vec.resize(1000);
+        arena.reset();
+    }
+    ASSERT_EQ(arena.heap_allocations(), allocations);
+
+    auto cat = spark::category(TClass::GetClass<test_waveform>(), {16}, false);
+
+    for (int event = 0; event < 3; ++event) {
+        for (size_t i = 0; i < 4; ++i) {
+            auto* wf = cat.make_object_unsafe<test_waveform>({i * 2});
+            ASSERT_EQ(wf->samples.get_allocator().resource(), cat.arena());
+            wf->samples.resize(100 * (i + 1));
+        }
+        cat.compress();
+        auto* kept = cat.get_object<test_waveform>(3);
+        ASSERT_EQ(kept->samples.size(), 400);
+        cat.clear();
+        ASSERT_EQ(cat.get_entries(), 0);
+
+        // The kept object no longer refers to the released arena
+        ASSERT_TRUE(kept->samples.empty());
+        ASSERT_EQ(kept->samples.get_allocator().resource(), std::pmr::get_default_resource());
+    }
+}
+
+TEST(TestCategory, SparseIndex)
+{
+    auto idx = spark::details::sparse_index();
+
+    ASSERT_EQ(idx.find(10), -1);
+
+    for (size_t i = 0; i < 1000; ++i) {
+        ASSERT_EQ(idx.insert(i * 4096), i);
+    }
+    ASSERT_EQ(idx.insert(4096), 1);
+    ASSERT_EQ(idx.size(), 1000);
+    ASSERT_EQ(idx.find(999 * 4096), 999);
+    ASSERT_EQ(idx.find(4095), -1);
+    ASSERT_EQ(idx.keys()[5], 5 * 4096);
+
+    idx.clear();
+    ASSERT_EQ(idx.size(), 0);
+    ASSERT_EQ(idx.find(4096), -1);
+
+    ASSERT_EQ(idx.insert(7), 0);
+    ASSERT_EQ(idx.insert(3), 1);
+    ASSERT_EQ(idx.find(7), 0);
+    ASSERT_EQ(idx.find(4096), -1);
+
+    idx.clear();
+    ASSERT_EQ(idx.find(7), -1);
+    ASSERT_EQ(idx.find(3), -1);
+}
+
+TEST(TestCategory, SparseStorage)
+{
+    auto cat = spark::category(TClass::GetClass<test_hit>(), {64, 256, 1024}, false, spark::storage_mode::sparse);
+
+    for (int event = 0; event < 2; ++event) {
+        auto* last = cat.make_object_unsafe<test_hit>({63, 255, 1023});
+        last->value = 3;
+        auto* first = cat.make_object_unsafe<test_hit>({0, 0, 7});
+        first->value = 1;
+        const std::vector<std::array<size_t, 3>> locs {{10, 20, 30}};
+        auto* mid = cat.make_objects<test_hit>(locs)[0];
+        mid->value = 2;
+
+        ASSERT_EQ(cat.get_object<test_hit>({0, 0, 7}), first);
+        ASSERT_EQ(cat.get_object<test_hit>({0, 0, 8}), nullptr);
+        ASSERT_EQ(cat.make_object_unsafe<test_hit>({0, 0, 7}), first);
+        first->value = 1;
+        ASSERT_EQ(cat.get_locator(0), (std::vector<size_t> {63, 255, 1023}));
+        ASSERT_EQ(cat.get_entries(), 3);
+
+        cat.compress();
+
+        ASSERT_EQ(cat.get_entries(), 3);
+        ASSERT_EQ(cat.get_object<test_hit>(0), first);
+        ASSERT_EQ(cat.get_object<test_hit>(1), mid);
+        ASSERT_EQ(cat.get_object<test_hit>(2), last);
+        ASSERT_EQ(cat.get_object<test_hit>({63, 255, 1023}), last);
+        ASSERT_EQ(cat.get_object<test_hit>({1, 0, 0}), nullptr);
+        ASSERT_EQ(cat.get_locator(1), (std::vector<size_t> {10, 20, 30}));
+
+        int counter {0};
+        for (auto [loc, obj] : cat.view<test_hit>()) {
+            ASSERT_EQ(obj.value, ++counter);
+        }
+        ASSERT_EQ(counter, 3);
+
+        cat.clear();
+        ASSERT_EQ(cat.get_entries(), 0);
+        ASSERT_EQ(cat.get_object<test_hit>({0, 0, 7}), nullptr);
+    }
+
+    for (size_t i = 0; i < 500; ++i) {
+        cat.make_object_unsafe<test_hit>({i % 64, i % 256, (i * 37) % 1024})->value = static_cast<int>(i);
+    }
+    cat.compress();
+    ASSERT_EQ(cat.get_entries(), 500);
+    ASSERT_EQ(cat.get_object<test_hit>({5, 5, (5 * 37) % 1024})->value, 5);
+
+    ASSERT_THROW(cat.make_object_unsafe<test_hit>({0, 0, 0}), std::runtime_error);
+}
+
+TEST(TestCategory, BatchedLocators)
+{
+    auto cat = spark::category(TClass::GetClass<test_hit>(), {3, 4}, false);
+
+    const std::vector<std::array<size_t, 2>> locs {{2, 1}, {0, 3}, {1, 0}};
+
+    auto objs = cat.make_objects<test_hit>(locs);
+    ASSERT_EQ(objs.size(), 3);
+    for (size_t i = 0; i < objs.size(); ++i) {
+        objs[i]->value = static_cast<int>(i);
+        ASSERT_EQ(cat.get_object<test_hit>(locs[i]), objs[i]);
+    }
+
+    const std::vector<std::vector<size_t>> queries {{0, 3}, {1, 1}, {2, 1}};
+    auto found = cat.get_objects<test_hit>(std::span<const std::vector<size_t>>(queries));
+    ASSERT_EQ(found.size(), 3);
+    ASSERT_EQ(found[0], objs[1]);
+    ASSERT_EQ(found[1], nullptr);
+    ASSERT_EQ(found[2], objs[0]);
+
+    const std::vector<std::array<size_t, 3>> wrong_dim {{0, 0, 0}};
+    ASSERT_THROW(cat.access<spark::policy::checked>().make_objects<test_hit>(wrong_dim), std::runtime_error);
+
+    const std::vector<std::vector<size_t>> mixed_dim {{0, 0}, {0}};
+    ASSERT_THROW(cat.access<spark::policy::checked>().get_objects<test_hit>(mixed_dim), std::runtime_error);
+
+    const std::vector<std::array<size_t, 2>> outside {{0, 0}, {3, 0}};
+    ASSERT_THROW(cat.make_objects<test_hit>(outside), std::out_of_range);
+
+    cat.compress();
+    ASSERT_EQ(cat.get_entries(), 3);
+    ASSERT_EQ(cat.get_object<test_hit>({1, 0})->value, 2);
+    ASSERT_THROW(cat.make_objects<test_hit>(locs), std::runtime_error);
+}
+
+TEST(TestCategory, ColumnCategory)
+{
+    auto cat = spark::category(TClass::GetClass<test_hit>(), {4, 8}, false);
+
+    auto* obj = cat.make_object_unsafe<test_hit>({1, 2});
+    obj->value = 5;
+    obj->energy = 1.5;
+
+    obj = cat.make_object_unsafe<test_hit>({0, 7});
+    obj->value = 3;
+    obj->energy = 2.5;
+
+    auto cols = spark::column_category<test_hit, &test_hit::value, &test_hit::energy>("hits", {"value", "energy"});
+    cols.gather(cat);
+
+    ASSERT_EQ(cols.size(), 2);
+    ASSERT_EQ(cols.column<&test_hit::value>()[0], 3);
+    ASSERT_EQ(cols.column<&test_hit::energy>()[1], 1.5);
+    ASSERT_EQ(cols.locators()[0], 7);
+    ASSERT_EQ(cols.locators()[1], 10);
+
+    for (auto& val : cols.column<&test_hit::value>()) {
+        val *= 2;
+    }
+    cols.scatter(cat);
+    ASSERT_EQ(cat.get_object<test_hit>({1, 2})->value, 10);
+
+    ASSERT_EQ(cols.emplace(3, 1, 2.F), 2);
+    ASSERT_EQ(cols.size(), 3);
+    ASSERT_THROW(cols.scatter(cat), std::runtime_error);
+
+    cols.clear();
+    ASSERT_EQ(cols.size(), 0);
+}
+
+TEST(TestCategory, Recycling)
+{
+    auto cat = spark::category(TClass::GetClass<test_recycled_hit>(), {10}, false);
+    cat.set_recycling(true);
+    ASSERT_TRUE(cat.is_recycling());
+
+    const auto constructed = test_recycled_hit::constructed;
+    for (size_t i = 0; i < 3; ++i) {
+        cat.make_object_at<test_recycled_hit>(i)->value = 7;
+    }
+    ASSERT_EQ(test_recycled_hit::constructed, constructed + 3);
+
+    cat.compress();
+    cat.clear();
+    ASSERT_EQ(cat.get_entries(), 0);
+
+    // Slots 1 and 2 are reset, slot 3 was never used
+    const auto resets = test_recycled_hit::resets;
+    for (size_t i = 1; i < 4; ++i) {
+        ASSERT_EQ(cat.make_object_at<test_recycled_hit>(i)->value, 0);
+    }
+    ASSERT_EQ(test_recycled_hit::constructed, constructed + 4);
+    ASSERT_EQ(test_recycled_hit::resets, resets + 2);
+    ASSERT_EQ(cat.get_entries(), 3);
+
+    // Prototype copy of trivially resettable class
+    auto sparse = spark::category(TClass::GetClass<test_hit>(), {1000}, false, spark::storage_mode::sparse);
+    sparse.set_recycling(true);
+    for (int event = 0; event < 3; ++event) {
+        const std::array<std::array<size_t, 1>, 2> locs {{{{100}}, {{900}}}};
+        for (auto* hit : sparse.make_objects<test_hit>(locs)) {
+            ASSERT_EQ(hit->value, 0);
+            ASSERT_EQ(hit->energy, 0);
+            hit->value = event + 1;
+            hit->energy = 1.5;
+        }
+        ASSERT_EQ(sparse.get_object<test_hit>({900})->value, event + 1);
+        sparse.clear();
+    }
 }
@@ -0,0 +1,696 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <spark/core/category_manager.hpp>
+#include <spark/core/column_category.hpp>
+#include <spark/core/task.hpp>
+#include <spark/core/task_manager.hpp>
+#include <spark/utils/bounded_queue.hpp>
+
+#include "test_objects.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class TestCategories : std::uint8_t
+{
+    Hits = 7,
+    Waveforms = 3,
+    Other = 255,
+};
+
+TEST(TestCategoryManager, FlatRegistry)
+{
+    auto mgr = spark::category_manager();
+
+    ASSERT_EQ(mgr.get_category(TestCategories::Hits), nullptr);
+    ASSERT_FALSE(mgr.get_category_info(TestCategories::Other).registered);
+    ASSERT_THROW(mgr.build_category<test_hit>(TestCategories::Hits), std::out_of_range);
+
+    ASSERT_TRUE(mgr.register_category(TestCategories::Hits, "Hits", {4, 8}, false));
+    ASSERT_TRUE(mgr.register_category(TestCategories::Waveforms, "Waveforms", {16}, false));
+    ASSERT_TRUE(mgr.register_category(TestCategories::Other, "Other", {2}, false));
+    ASSERT_TRUE(mgr.register_category(TestCategories::Hits, "Hits", {4, 8}, false));
+
+    ASSERT_EQ(mgr.get_category_info(TestCategories::Other).cat_id, 255);
+    ASSERT_EQ(mgr.get_category(TestCategories::Hits), nullptr);
+
+    auto* hits = mgr.build_category<test_hit>(TestCategories::Hits);
+    ASSERT_NE(hits, nullptr);
+    ASSERT_EQ(mgr.build_category<test_hit>(TestCategories::Hits), hits);
+    ASSERT_EQ(mgr.get_category(TestCategories::Hits), hits);
+
+    auto* waveforms = mgr.build_category<test_waveform>(TestCategories::Waveforms);
+
+    // Iteration follows the category IDs, not the registration order
+    std::vector<std::string> names;
+    mgr.build_from_model([&](spark::category_info& cinfo) { names.emplace_back(cinfo.name); });
+    ASSERT_EQ(names, (std::vector<std::string> {"Waveforms", "Hits", "Other"}));
+
+    hits->make_object_unsafe<test_hit>({1, 2});
+    waveforms->make_object_unsafe<test_waveform>({3});
+
+    mgr.compress();
+    ASSERT_TRUE(hits->get_entries() == 1 and waveforms->get_entries() == 1);
+
+    mgr.clear();
+    ASSERT_EQ(hits->get_entries(), 0);
+    ASSERT_EQ(waveforms->get_entries(), 0);
+}
+
+TEST(TestCategoryManager, TypedHandle)
+{
+    auto mgr = spark::category_manager();
+
+    mgr.register_category(TestCategories::Hits, "Hits", {4, 8}, false);
+    mgr.register_category(TestCategories::Waveforms, "Waveforms", {16}, false);
+
+    ASSERT_THROW((mgr.handle<TestCategories::Hits, test_hit>()), std::out_of_range);
+
+    auto* hits = mgr.build_category<test_hit>(TestCategories::Hits);
+
+    ASSERT_THROW((mgr.handle<TestCategories::Hits, test_other_hit>()), std::runtime_error);
+
+    auto handle = mgr.handle<TestCategories::Hits, test_hit>();
+    ASSERT_TRUE(handle);
+    ASSERT_EQ(handle.get(), hits);
+
+    handle.make_object_unsafe({2, 5})->value = 2;
+    handle.make_object_unsafe({0, 1})->value = 1;
+    ASSERT_EQ(handle.get_object({2, 5})->value, 2);
+    ASSERT_EQ(handle.get_object({3, 3}), nullptr);
+    ASSERT_EQ(handle.get_entries(), 2);
+
+    ASSERT_EQ(handle.at(0)->value, 1);
+    ASSERT_EQ(handle.view()[1].second.value, 2);
+
+    // The handle follows the category pointer of the manager
+    auto& cinfo = mgr.get_category_info(TestCategories::Hits);
+    auto other = spark::category(TClass::GetClass<test_hit>(), {4, 8}, false);
+    cinfo.ptr = &other;
+    ASSERT_EQ(handle.get(), &other);
+    ASSERT_EQ(handle.get_entries(), 0);
+    cinfo.ptr = hits;
+
+    auto empty = spark::category_handle<test_hit>();
+    ASSERT_FALSE(empty);
+}
+
+TEST(TestCategoryManager, ParallelMaintenance)
+{
+    auto mgr = spark::category_manager();
+    mgr.set_parallel(4, 10);
+
+    std::vector<spark::category*> cats;
+    for (uint8_t id = 0; id < 16; ++id) {
+        const auto cat = static_cast<TestCategories>(id);
+        mgr.register_category(cat, "Cat" + std::to_string(id), {8, 8}, false, spark::storage_mode::sparse);
+        cats.push_back(mgr.build_category<test_hit>(cat));
+    }
+
+    for (int event = 0; event < 20; ++event) {
+        // Small event below threshold goes serial, large one parallel
+        const size_t n_hits = event % 2 ? 1 : 20;
+        for (size_t i = 0; i < cats.size(); ++i) {
+            for (size_t hit = 0; hit < n_hits; ++hit) {
+                cats[i]->make_object_unsafe<test_hit>({hit / 8, (hit + i) % 8})->value = static_cast<int>(hit);
+            }
+        }
+
+        mgr.compress();
+        for (auto* cat : cats) {
+            ASSERT_EQ(cat->size(), n_hits);
+            ASSERT_EQ(cat->get_entries(), n_hits);
+        }
+
+        mgr.clear();
+        for (auto* cat : cats) {
+            ASSERT_EQ(cat->size(), 0);
+        }
+    }
+}
+
+TEST(TestCategoryManager, TouchedCategories)
+{
+    auto mgr = spark::category_manager();
+
+    mgr.register_category(TestCategories::Hits, "Hits", {8, 8}, false);
+    mgr.register_category(TestCategories::Waveforms, "Waveforms", {8}, false);
+    mgr.register_category(TestCategories::Other, "Other", {8}, false);
+
+    auto* cat_hits = mgr.build_category<test_hit>(TestCategories::Hits);
+    auto* cat_waves = mgr.build_category<test_hit>(TestCategories::Waveforms);
+    auto* cat_other = mgr.build_category<test_hit>(TestCategories::Other);
+
+    ASSERT_TRUE(mgr.get_touched().empty());
+
+    cat_other->make_object_unsafe<test_hit>({1});
+    cat_hits->make_object_unsafe<test_hit>({1, 2});
+    cat_hits->make_object_unsafe<test_hit>({3, 4});
+    ASSERT_EQ(mgr.get_touched().size(), 2);
+
+    mgr.compress();
+    ASSERT_EQ(std::vector<uint8_t>(mgr.get_touched().begin(), mgr.get_touched().end()),
+              (std::vector<uint8_t> {7, 255}));
+    ASSERT_TRUE(cat_hits->is_touched());
+    ASSERT_FALSE(cat_waves->is_touched());
+    ASSERT_EQ(cat_hits->get_entries(), 2);
+    ASSERT_EQ(cat_other->get_entries(), 1);
+
+    mgr.clear();
+    ASSERT_TRUE(mgr.get_touched().empty());
+    ASSERT_FALSE(cat_hits->is_touched());
+    ASSERT_EQ(cat_hits->size(), 0);
+    ASSERT_EQ(cat_other->size(), 0);
+
+    // Untouched category is empty and stays open after indexed access
+    ASSERT_EQ(cat_waves->get_entries(), 0);
+
+    // Category cleared behind the manager's back is reported once
+    cat_waves->make_object_unsafe<test_hit>({0});
+    cat_waves->clear();
+    cat_waves->make_object_unsafe<test_hit>({5});
+    mgr.compress();
+    ASSERT_EQ(mgr.get_touched().size(), 1);
+    ASSERT_EQ(mgr.get_touched()[0], 3);
+    ASSERT_EQ(cat_waves->get_entries(), 1);
+    mgr.clear();
+}
+
+TEST(TestCategoryManager, ViewEmptyEvent)
+{
+    auto mgr = spark::category_manager();
+
+    mgr.register_category(TestCategories::Hits, "Hits", {8}, false);
+    auto* cat_hits = mgr.build_category<test_hit>(TestCategories::Hits);
+
+    cat_hits->make_object_unsafe<test_hit>({1});
+    mgr.compress();
+    mgr.clear();
+
+    // Viewing the empty event must not close the category for the next one
+    ASSERT_EQ(cat_hits->view<test_hit>().size(), 0);
+    ASSERT_EQ(cat_hits->get_object<test_hit>(0), nullptr);
+    ASSERT_TRUE(mgr.get_touched().empty());
+    mgr.compress();
+    mgr.clear();
+
+    ASSERT_NO_THROW(cat_hits->make_object_unsafe<test_hit>({2}));
+    mgr.compress();
+    ASSERT_EQ(cat_hits->get_entries(), 1);
+    ASSERT_EQ((*cat_hits->view<test_hit>().begin()).first[0], 2);
+    mgr.clear();
+}
+
+TEST(TestCategoryManager, EventBuffers)
+{
+    auto mgr = spark::category_manager();
+    mgr.register_category(TestCategories::Hits, "Hits", {8}, false);
+    mgr.register_category(TestCategories::Other, "Other", {8}, false);
+
+    ASSERT_THROW(mgr.set_buffers(0), std::out_of_range);
+    ASSERT_THROW(mgr.set_buffers(spark::category_manager::max_buffers + 1), std::out_of_range);
+    mgr.set_buffers(2);
+
+    mgr.build_category<test_hit>(TestCategories::Hits);
+    ASSERT_THROW(mgr.set_buffers(3), std::logic_error);
+
+    auto hits = mgr.handle<TestCategories::Hits, test_hit>();
+    auto input = mgr.input_handle<TestCategories::Hits, test_hit>();
+    ASSERT_THROW((mgr.input_handle<TestCategories::Other, test_hit>()), std::out_of_range);
+
+    mgr.fill_buffer(1);
+    ASSERT_NE(hits.get(), input.get());
+    ASSERT_EQ(input.get(), mgr.get_input_category(TestCategories::Hits));
+
+    // Sources fill the next event while the current one is processed
+    hits.make_object_unsafe({1})->value = 10;
+    input.make_object_unsafe({2})->value = 20;
+    input.make_object_unsafe({3})->value = 30;
+
+    mgr.compress();
+    ASSERT_EQ(hits.get_entries(), 1);
+    ASSERT_EQ(hits.at(0)->value, 10);
+    ASSERT_EQ(input.get()->size(), 2);
+
+    mgr.use_buffer(1);
+    mgr.fill_buffer(0);
+    mgr.clear_input();
+    ASSERT_EQ(input.get()->size(), 0);
+
+    mgr.compress();
+    ASSERT_EQ(hits.get_entries(), 2);
+    ASSERT_EQ(hits.at(1)->value, 30);
+
+    // Output selects its buffer independently of the tasks
+    const auto& cinfo = mgr.get_category_info(TestCategories::Hits);
+    ASSERT_EQ(cinfo.output, input.get());
+    auto* processed = hits.get();
+    mgr.write_buffer(1);
+    ASSERT_EQ(cinfo.output, processed);
+    mgr.use_buffer(0);
+    ASSERT_EQ(cinfo.output, processed);
+    ASSERT_NE(cinfo.output, hits.get());
+}
+
+TEST(TestCategoryManager, EventBuffersPipeline)
+{
+    constexpr int n_events = 200;
+
+    auto mgr = spark::category_manager();
+    mgr.register_category(TestCategories::Hits, "Hits", {64}, false);
+    mgr.set_buffers(3);
+    mgr.build_category<test_hit>(TestCategories::Hits);
+
+    auto hits = mgr.handle<TestCategories::Hits, test_hit>();
+    auto input = mgr.input_handle<TestCategories::Hits, test_hit>();
+
+    spark::utils::bounded_queue<size_t> free_buffers(mgr.get_buffers());
+    spark::utils::bounded_queue<size_t> ready_buffers(mgr.get_buffers());
+    for (size_t buf = 0; buf < mgr.get_buffers(); ++buf) {
+        free_buffers.push(buf);
+    }
+
+    auto reader = std::jthread(
+        [&]
+        {
+            for (int event = 0; event < n_events; ++event) {
+                auto buf = free_buffers.pop();
+                mgr.fill_buffer(*buf);
+                mgr.clear_input();
+                for (int i = 0; i <= event % 10; ++i) {
+                    input.make_object_unsafe({static_cast<size_t>(i)})->value = event;
+                }
+                ready_buffers.push(*buf);
+            }
+            ready_buffers.close();
+        });
+
+    int event {0};
+    while (auto buf = ready_buffers.pop()) {
+        mgr.use_buffer(*buf);
+        mgr.compress();
+        EXPECT_EQ(hits.get_entries(), event % 10 + 1);
+        for (auto [loc, hit] : hits.view()) {
+            EXPECT_EQ(hit.value, event);
+        }
+        free_buffers.push(*buf);
+        ++event;
+    }
+
+    ASSERT_EQ(event, n_events);
+}
+
+namespace
+{
+class copy_task : public spark::task
+{
+public:
+    using task::task;
+
+    auto init() -> bool override
+    {
+        hits = model()->handle<TestCategories::Hits, test_hit>();
+        return true;
+    }
+
+    auto execute() -> bool override
+    {
+        ++calls;
+        sum += hits.get_entries();
+        return true;
+    }
+
+    spark::category_handle<test_hit> hits;
+    int calls {0};
+    int sum {0};
+};
+}  // namespace
+
+TEST(TestCategoryManager, EventBatch)
+{
+    auto mgr = spark::category_manager();
+    mgr.register_category(TestCategories::Hits, "Hits", {16}, false, spark::storage_mode::sparse);
+    mgr.set_batch(4);
+    ASSERT_EQ(mgr.get_batch(), 4);
+    ASSERT_EQ(mgr.get_buffers(), 4);
+
+    mgr.build_category<test_hit>(TestCategories::Hits);
+    auto input = mgr.input_handle<TestCategories::Hits, test_hit>();
+    auto batch = mgr.batch_handle<TestCategories::Hits, test_hit>();
+
+    ASSERT_THROW(mgr.set_batch_events(5), std::out_of_range);
+
+    for (int round = 0; round < 3; ++round) {
+        mgr.clear_batch();
+        ASSERT_EQ(batch.size(), 0);
+
+        // Last batch is incomplete
+        const size_t n_events = round == 2 ? 2 : 4;
+        for (size_t evt = 0; evt < n_events; ++evt) {
+            mgr.fill_buffer(evt);
+            for (size_t i = 0; i <= evt; ++i) {
+                input.make_object_unsafe({15 - i})->value = static_cast<int>(evt * 100 + i);
+            }
+        }
+        mgr.set_batch_events(n_events);
+        ASSERT_EQ(batch.size(), n_events);
+
+        auto offsets = batch.offsets();
+        ASSERT_EQ(offsets.size(), n_events + 1);
+        for (size_t evt = 0; evt < n_events; ++evt) {
+            ASSERT_EQ(offsets[evt + 1] - offsets[evt], evt + 1);
+            ASSERT_EQ(batch.event(evt).size(), evt + 1);
+            // Compressed in order of positions
+            ASSERT_EQ(batch.event(evt)[0].second.value, static_cast<int>(evt * 100 + evt));
+        }
+
+        int total {0};
+        batch.for_each([&](size_t evt, auto /*loc*/, test_hit& hit)
+                       { total += hit.value - static_cast<int>(evt * 100); });
+        ASSERT_EQ(total, round == 2 ? 1 : 10);
+
+        auto task = copy_task(&mgr, nullptr);
+        task.init();
+        ASSERT_TRUE(task.execute_batch(n_events));
+        ASSERT_EQ(task.calls, n_events);
+        ASSERT_EQ(task.sum, round == 2 ? 3 : 10);
+
+        mgr.compress_batch();
+    }
+
+    auto cols = spark::column_category<test_hit, &test_hit::value>("hits", {"value"});
+    cols.gather(batch);
+    ASSERT_EQ(cols.size(), 3);
+    ASSERT_EQ(cols.event_offsets().size(), 3);
+    ASSERT_EQ(cols.event_offsets()[1], 1);
+    ASSERT_EQ(cols.column<&test_hit::value>()[0], 0);
+    ASSERT_EQ(cols.column<&test_hit::value>()[1], 101);
+    ASSERT_EQ(cols.locators()[2], 15);
+}
+
+TEST(TestCategoryManager, EventBatchMemoryLimit)
+{
+    // Dense category of 16 x 16 cells preallocates two pointers per cell in each event
+    constexpr size_t per_event = 2 * 256 * sizeof(TObject*);
+
+    {
+        auto mgr = spark::category_manager();
+        mgr.register_category(TestCategories::Hits, "Hits", {16, 16}, false);
+        mgr.set_batch(8);
+        mgr.build_category<test_hit>(TestCategories::Hits);
+        ASSERT_EQ(mgr.get_batch(), 8);
+        ASSERT_EQ(mgr.get_buffers(), 8);
+    }
+
+    {
+        auto mgr = spark::category_manager();
+        mgr.register_category(TestCategories::Hits, "Hits", {16, 16}, false);
+        ASSERT_THROW(mgr.set_batch(8, (8 * per_event) - 1), std::length_error);
+        ASSERT_EQ(mgr.get_batch(), 1);
+        mgr.set_batch(8, 8 * per_event);
+        ASSERT_EQ(mgr.get_batch(), 8);
+    }
+
+    {
+        // The sparse storage does not preallocate the volume
+        auto mgr = spark::category_manager();
+        mgr.register_category(TestCategories::Hits, "Hits", {1024, 1024}, false, spark::storage_mode::sparse);
+        mgr.set_batch(8, 1);
+        mgr.build_category<test_hit>(TestCategories::Hits);
+        ASSERT_EQ(mgr.get_batch(), 8);
+    }
+
+    {
+        // The categories registered after the batch is set are checked when built
+        auto mgr = spark::category_manager();
+        mgr.register_category(TestCategories::Hits, "Hits", {16, 16}, false);
+        mgr.set_batch(4, 4 * per_event);
+        mgr.register_category(TestCategories::Waveforms, "Waveforms", {16, 16}, false);
+        mgr.build_category<test_hit>(TestCategories::Hits);
+        ASSERT_THROW(mgr.build_category<test_waveform>(TestCategories::Waveforms), std::length_error);
+        ASSERT_EQ(mgr.get_category(TestCategories::Waveforms), nullptr);
+    }
+}
+
+TEST(TestCategoryManager, MemoryAccounting)
+{
+    auto mgr = spark::category_manager();
+    mgr.register_category(TestCategories::Hits, "Hits", {16, 16}, false);
+    mgr.register_category(TestCategories::Waveforms, "Waveforms", {1024}, false, spark::storage_mode::sparse);
+
+    auto* cat_hits = mgr.build_category<test_hit>(TestCategories::Hits);
+    auto* cat_waves = mgr.build_category<test_waveform>(TestCategories::Waveforms);
+
+    const auto empty = mgr.get_memory(TestCategories::Hits);
+    ASSERT_GE(empty.preallocated, 2 * 256 * sizeof(TObject*));
+    ASSERT_EQ(empty.in_use, 0);
+    ASSERT_EQ(empty.retained, 0);
+
+    // Sparse storage does not preallocate the volume
+    ASSERT_LT(mgr.get_memory(TestCategories::Waveforms).preallocated, empty.preallocated);
+
+    for (size_t event = 0; event < 4; ++event) {
+        for (size_t i = 0; i < event * 2; ++i) {
+            cat_hits->make_object_unsafe<test_hit>({i, i});
+        }
+        cat_waves->make_object_unsafe<test_waveform>({event * 100})->samples.resize(100);
+
+        mgr.compress();
+        if (event == 3) {
+            const auto mem = mgr.get_memory(TestCategories::Hits);
+            ASSERT_EQ(mem.in_use, 6 * sizeof(test_hit));
+            ASSERT_GE(mem.retained, mem.in_use);
+            ASSERT_GE(mem.peak(), mem.current());
+            ASSERT_GT(mgr.get_memory(TestCategories::Waveforms).payload, 0);
+        }
+        mgr.clear();
+    }
+
+    const auto hits = mgr.get_stats(TestCategories::Hits);
+    ASSERT_EQ(hits.events, 4);
+    ASSERT_EQ(hits.filled_max, 6);
+    ASSERT_DOUBLE_EQ(hits.mean_filled(), 3.0);
+
+    const auto waves = mgr.get_stats(TestCategories::Waveforms);
+    ASSERT_EQ(waves.filled_max, 1);
+    ASSERT_DOUBLE_EQ(waves.mean_filled(), 1.0);
+
+    // Memory is kept for reuse after clear
+    ASSERT_EQ(mgr.get_memory(TestCategories::Hits).in_use, 0);
+    ASSERT_GE(mgr.get_memory(TestCategories::Hits).retained, 6 * sizeof(test_hit));
+
+    mgr.print_stats();
+}
+
+namespace
+{
+constexpr auto test_model =
+    spark::make_model(spark::define_category<test_hit>(TestCategories::Hits, "Hits", {4, 8}),
+                      spark::define_category<test_waveform>(TestCategories::Waveforms, "Waveforms", {16}, false),
+                      spark::define_category<test_hit>(TestCategories::Other, "Other", {1024}, true, false,
+                                                       spark::storage_mode::sparse));
+
+static_assert(test_model.size() == 3);
+static_assert(test_model.defs[0].shape().size() == 2 and test_model.defs[0].shape()[1] == 8);
+}  // namespace
+
+TEST(TestCategoryManager, CompileTimeModel)
+{
+    auto mgr = spark::category_manager();
+    ASSERT_TRUE(mgr.register_model(test_model));
+
+    const auto& hits_info = mgr.get_category_info(TestCategories::Hits);
+    ASSERT_TRUE(hits_info.registered);
+    ASSERT_EQ(hits_info.name.data(), test_model.defs[0].name.data());
+    ASSERT_TRUE(hits_info.name_storage.empty());
+    ASSERT_EQ(hits_info.dim, 2);
+    ASSERT_EQ(mgr.get_category_info(TestCategories::Other).mode, spark::storage_mode::sparse);
+
+    // Class must match the declaration
+    ASSERT_THROW(mgr.build_category<test_waveform>(TestCategories::Hits), std::runtime_error);
+
+    mgr.build_model(test_model);
+    auto* hits = mgr.get_category(TestCategories::Hits);
+    ASSERT_NE(hits, nullptr);
+    ASSERT_TRUE(hits->stores<test_hit>());
+    ASSERT_EQ(hits->get_data_size(), 32);
+    ASSERT_TRUE(mgr.get_category(TestCategories::Waveforms)->stores<test_waveform>());
+
+    ASSERT_TRUE(mgr.get_category_info(TestCategories::Hits).persistent);
+    ASSERT_FALSE(mgr.get_category_info(TestCategories::Waveforms).persistent);
+
+    // Handles work the same way as for runtime registration
+    auto waveforms = mgr.handle<TestCategories::Waveforms, test_waveform>();
+    waveforms.make_object_unsafe({3});
+    ASSERT_EQ(waveforms.get_entries(), 1);
+}
+
+TEST(TestCategoryManager, RuntimeRegistrationOwnsName)
+{
+    auto mgr = spark::category_manager();
+
+    {
+        auto name = std::string("Temporary");
+        std::initializer_list<size_t> sizes {3, 5};
+        mgr.register_category(TestCategories::Hits, name, sizes, false);
+        name.assign("Overwritten");
+    }
+
+    const auto& cinfo = mgr.get_category_info(TestCategories::Hits);
+    ASSERT_EQ(cinfo.name, "Temporary");
+    ASSERT_EQ(cinfo.shape().size(), 2);
+    ASSERT_EQ(cinfo.shape()[1], 5);
+
+    ASSERT_THROW(mgr.register_category(TestCategories::Other, "Other", {1, 1, 1, 1, 1, 1, 1, 1, 1}, false),
+                 std::out_of_range);
+
+    auto* hits = mgr.build_category<test_hit>(TestCategories::Hits);
+    ASSERT_EQ(hits->get_data_size(), 15);
+}
+
+namespace
+{
+class sum_task : public spark::task
+{
+public:
+    using task::task;
+
+    auto init() -> bool override
+    {
+        model()->build_category<test_hit>(TestCategories::Other);
+        hits = model()->handle<TestCategories::Hits, test_hit>();
+        sums = model()->handle<TestCategories::Other, test_hit>();
+        return true;
+    }
+
+    auto execute() -> bool override
+    {
+        int sum {0};
+        for (auto [loc, hit] : hits.view()) {
+            sum += hit.value;
+        }
+        sums.make_object_unsafe({0})->value = sum;
+        return true;
+    }
+
+    auto replicate(spark::category_manager* catmgr, spark::database* dbmgr) const -> std::unique_ptr<task> override
+    {
+        return std::make_unique<sum_task>(catmgr, dbmgr);
+    }
+
+    spark::category_handle<test_hit> hits;
+    spark::category_handle<test_hit> sums;
+};
+}  // namespace
+
+TEST(TestCategoryManager, ParallelWorkers)
+{
+    constexpr int n_events = 300;
+    constexpr size_t n_workers = 3;
+
+    auto mgr = spark::category_manager();
+    mgr.register_category(TestCategories::Hits, "Hits", {64}, false);
+    mgr.register_category(TestCategories::Other, "Other", {1}, false);
+    mgr.set_buffers(n_workers + 1);
+    mgr.build_category<test_hit>(TestCategories::Hits);
+
+    auto tasks = spark::task_manager(&mgr, nullptr);
+    tasks.add_task<sum_task>();
+    tasks.build_queue();
+
+    // Categories must be built by the main tasks before the views are created
+    ASSERT_THROW(mgr.make_view()->build_category<test_hit>(TestCategories::Other), std::logic_error);
+    tasks.init_tasks();
+
+    auto plain_tasks = spark::task_manager(&mgr, nullptr);
+    plain_tasks.add_task<copy_task>();
+    plain_tasks.build_queue();
+    ASSERT_THROW(plain_tasks.replicate(&mgr), std::logic_error);
+
+    std::vector<std::unique_ptr<spark::category_manager>> views;
+    std::vector<std::unique_ptr<spark::task_manager>> replicas;
+    for (size_t w = 0; w < n_workers; ++w) {
+        views.push_back(mgr.make_view());
+        replicas.push_back(tasks.replicate(views.back().get()));
+        replicas.back()->init_tasks();
+    }
+
+    using event_slot = std::pair<int, size_t>;
+    spark::utils::bounded_queue<size_t> free_buffers(mgr.get_buffers());
+    spark::utils::bounded_queue<event_slot> ready_events(mgr.get_buffers());
+    spark::utils::bounded_queue<event_slot> done_events(mgr.get_buffers());
+    for (size_t buf = 0; buf < mgr.get_buffers(); ++buf) {
+        free_buffers.push(buf);
+    }
+
+    auto input = mgr.input_handle<TestCategories::Hits, test_hit>();
+    auto reader = std::jthread(
+        [&]
+        {
+            for (int event = 0; event < n_events; ++event) {
+                auto buf = free_buffers.pop();
+                mgr.fill_buffer(*buf);
+                mgr.clear_input();
+                for (int i = 0; i <= event % 5; ++i) {
+                    input.make_object_unsafe({static_cast<size_t>(i)})->value = event;
+                }
+                ready_events.push({event, *buf});
+            }
+            ready_events.close();
+        });
+
+    std::atomic<size_t> running {n_workers};
+    std::vector<std::jthread> workers;
+    for (size_t w = 0; w < n_workers; ++w) {
+        workers.emplace_back(
+            [&, w]
+            {
+                while (auto item = ready_events.pop()) {
+                    views[w]->use_buffer(item->second);
+                    replicas[w]->execute_tasks();
+                    mgr.compress_buffer(item->second);
+                    done_events.push(*item);
+                }
+                if (--running == 0) {
+                    done_events.close();
+                }
+            });
+    }
+
+    // Ordered output
+    auto sums = mgr.handle<TestCategories::Other, test_hit>();
+    std::map<int, size_t> pending;
+    int next {0};
+    while (auto item = done_events.pop()) {
+        pending.emplace(*item);
+        for (auto iter = pending.begin(); iter != pending.end() and iter->first == next; iter = pending.erase(iter)) {
+            mgr.use_buffer(iter->second);
+            mgr.record_buffer(iter->second);
+            EXPECT_EQ(sums.get_entries(), 1);
+            EXPECT_EQ(sums.at(0)->value, next * (next % 5 + 1));
+            free_buffers.push(iter->second);
+            ++next;
+        }
+    }
+
+    ASSERT_EQ(next, n_events);
+    ASSERT_EQ(mgr.get_stats(TestCategories::Hits).events, n_events);
+    ASSERT_EQ(mgr.get_stats(TestCategories::Hits).filled_max, 5);
+    ASSERT_EQ(mgr.get_stats(TestCategories::Other).filled_sum, n_events);
+}
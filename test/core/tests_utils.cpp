@@ -9,10 +9,18 @@
 #include <gtest/gtest.h>
 
 #include <spark/core/types.hpp>
+#include <spark/utils/bounded_queue.hpp>
 #include <spark/utils/string_functions.hpp>
+#include <spark/utils/thread_pool.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <initializer_list>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include <spdlog/spdlog.h>
 
@@ -69,3 +77,89 @@ TEST(TestUtils, ConvertToTuple)
     // ASSERT_EQ(spark::coreutils::convert_to_tuple<size_t>({0, 1}), (std::tuple<size_t, size_t> {0, 1}));
     // ASSERT_EQ(spark::coreutils::convert_to_tuple<size_t>({0, 1, 2}), (std::tuple<size_t, size_t, size_t> {0, 1, 2}));
 }
+
+TEST(TestUtils, ThreadPool)
+{
+    auto pool = spark::utils::thread_pool(3);
+    ASSERT_EQ(pool.size(), 4);
+
+    for (int round = 0; round < 50; ++round) {
+        std::vector<int> hits(100, 0);
+        std::atomic<int> sum {0};
+        pool.parallel_for(hits.size(),
+                          [&](size_t idx)
+                          {
+                              hits[idx]++;
+                              sum += static_cast<int>(idx);
+                          });
+        ASSERT_EQ(sum, 4950);
+        ASSERT_TRUE(std::ranges::all_of(hits, [](int val) { return val == 1; }));
+    }
+
+    pool.parallel_for(0, [](size_t) { throw std::logic_error("never called"); });
+
+    ASSERT_THROW(pool.parallel_for(10,
+                                   [](size_t idx)
+                                   {
+                                       if (idx == 7) {
+                                           throw std::runtime_error("job failed");
+                                       }
+                                   }),
+                 std::runtime_error);
+}
+
+TEST(TestUtils, BoundedQueue)
+{
+    auto queue = spark::utils::bounded_queue<int>(4);
+    ASSERT_EQ(queue.get_capacity(), 4);
+
+    auto producer = std::jthread(
+        [&]
+        {
+            for (int i = 0; i < 1000; ++i) {
+                queue.push(i);
+            }
+            queue.close();
+        });
+
+    int expected {0};
+    while (auto value = queue.pop()) {
+        ASSERT_EQ(*value, expected++);
+        ASSERT_LE(queue.size(), 4);
+    }
+    ASSERT_EQ(expected, 1000);
+
+    ASSERT_FALSE(queue.push(1));
+    ASSERT_FALSE(queue.pop().has_value());
+}
+
+TEST(TestUtils, BoundedQueueStalls)
+{
+    using namespace std::chrono_literals;
+
+    auto queue = spark::utils::bounded_queue<int>(1);
+    queue.push(0);
+    ASSERT_EQ(queue.push_stall(), 0ns);
+    ASSERT_EQ(queue.pop_stall(), 0ns);
+
+    // Full queue, the producer waits in push() until the consumer pops. If the consumer was first, the push did not
+    // wait, the queue is full again and the round is repeated.
+    while (queue.push_stall() == 0ns) {
+        auto consumer = std::jthread([&] { queue.pop(); });
+        queue.push(1);
+    }
+    ASSERT_GT(queue.push_stall(), 0ns);
+    // The consumer always found an element
+    ASSERT_EQ(queue.pop_stall(), 0ns);
+
+    // Empty queue, the consumer waits in pop() until the producer pushes, repeated in the same way
+    queue.pop();
+    const auto push_stall = queue.push_stall();
+    while (queue.pop_stall() == 0ns) {
+        auto producer = std::jthread([&] { queue.push(2); });
+        ASSERT_EQ(queue.pop(), 2);
+    }
+    ASSERT_GT(queue.pop_stall(), 0ns);
+    // The producer always found free space
+    ASSERT_EQ(queue.push_stall(), push_stall);
+}
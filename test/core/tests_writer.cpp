@@ -0,0 +1,732 @@
+/*************************************************************************
+ * Copyright (C) 2025, Rafał Lalik <rafal.lalik@uj.edu.pl>               *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * For the licensing terms see LICENSE file.                             *
+ * For the list of contributors see README.md file.                      *
+ *************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <spark/core/category.hpp>
+#include <spark/core/category_model.hpp>
+#include <spark/core/data_source.hpp>
+#include <spark/core/task.hpp>
+#include <spark/core/writer_ntuple.hpp>
+#include <spark/core/writer_tree.hpp>
+#include <spark/spark.hpp>
+
+#include "test_objects.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ROOT/RNTupleReader.hxx>
+#include <ROOT/RNTupleView.hxx>
+
+#include <TBranch.h>
+#include <TChain.h>
+#include <TFile.h>
+#include <TList.h>
+#include <TObjArray.h>
+#include <TParameter.h>
+#include <TTree.h>
+
+namespace
+{
+enum class WriterCategories : std::uint8_t
+{
+    Raw = 0,
+    Cal = 1,
+};
+
+constexpr auto writer_model =
+    spark::make_model(spark::define_category<test_hit>(WriterCategories::Raw, "Raw", {16}, false),
+                      spark::define_category<test_hit>(WriterCategories::Cal, "Cal", {16}));
+
+/// Number of hits of the event
+auto hits_in_event(uint64_t event) -> size_t
+{
+    return (event % 4) + 1;
+}
+
+/// Fills the raw hits of each event, the value of each hit is the event number
+class counting_source : public spark::data_source
+{
+public:
+    counting_source(spark::category_manager& cat_mgr, uint64_t events)
+        : raw {cat_mgr.input_handle<WriterCategories::Raw, test_hit>()}
+        , n_events {events}
+    {
+    }
+
+    auto open() -> bool override { return true; }
+
+    auto close() -> bool override { return true; }
+
+    auto read_current_event() -> bool override
+    {
+        const auto event = get_current_event();
+        if (event >= n_events) {
+            return false;
+        }
+
+        for (size_t i = 0; i < hits_in_event(event); ++i) {
+            raw.make_object_unsafe({i})->value = static_cast<int>(event);
+        }
+        return true;
+    }
+
+private:
+    spark::category_handle<test_hit> raw;
+    uint64_t n_events {0};
+};
+
+/// Copies the raw hits into the persistent category
+class copy_hits_task : public spark::task
+{
+public:
+    using task::task;
+
+    auto init() -> bool override
+    {
+        raw = model()->handle<WriterCategories::Raw, test_hit>();
+        cal = model()->handle<WriterCategories::Cal, test_hit>();
+        return true;
+    }
+
+    auto execute() -> bool override
+    {
+        for (auto [loc, hit] : raw.view()) {
+            cal.make_object_unsafe({loc[0]})->value = hit.value;
+        }
+        return true;
+    }
+
+    auto replicate(spark::category_manager* catmgr, spark::database* dbmgr) const -> std::unique_ptr<task> override
+    {
+        return std::make_unique<copy_hits_task>(catmgr, dbmgr);
+    }
+
+    spark::category_handle<test_hit> raw;
+    spark::category_handle<test_hit> cal;
+};
+
+/// Spark system with the counting source and the copy task. The categories are built before the writer is created.
+struct writer_setup
+{
+    explicit writer_setup(uint64_t events, size_t buffers = 1, bool copy = true)
+    {
+        sprk.use_model(writer_model);
+        sprk.model().set_buffers(buffers);
+        if (copy) {
+            sprk.model().build_model(writer_model);
+            sprk.tasks().add_task<copy_hits_task>();
+        } else {
+            // Only the raw hits are written, the calibrated ones may come from the input
+            sprk.model().build_category<test_hit>(WriterCategories::Raw, true);
+        }
+
+        source = std::make_unique<counting_source>(sprk.model(), events);
+        sprk.add_source(source.get());
+    }
+
+    auto make_writer(const std::string& file_name) -> spark::writer::tree
+    {
+        return sprk.create_writer<spark::writer::tree>("T", file_name, 0);
+    }
+
+    spark::sparksys sprk {std::in_place_type<WriterCategories>};
+    std::unique_ptr<counting_source> source;
+};
+
+/**
+ * Check the hits of the entries of the output tree. The events are expected in the input order, starting from
+ * first_event.
+ */
+auto check_entries(TTree* tree, uint64_t first_event) -> void
+{
+    spark::category* cal {nullptr};
+    tree->SetBranchAddress("Cal", &cal);
+
+    for (Long64_t entry = 0; entry < tree->GetEntries(); ++entry) {
+        tree->GetEntry(entry);
+
+        const auto event = first_event + static_cast<uint64_t>(entry);
+        ASSERT_NE(cal, nullptr);
+        ASSERT_EQ(static_cast<size_t>(cal->get_entries()), hits_in_event(event));
+        for (size_t i = 0; i < hits_in_event(event); ++i) {
+            auto* hit = cal->get_object_at<test_hit>(i);
+            ASSERT_NE(hit, nullptr);
+            ASSERT_EQ(hit->value, static_cast<int>(event));
+        }
+    }
+
+    tree->ResetBranchAddresses();
+    delete cal;
+}
+
+/**
+ * Count the events of the entries of the output tree, in any order. Each entry must hold the hits of its event.
+ *
+ * \param written number of entries of each event, incremented
+ */
+auto count_events(TTree* tree, std::vector<int>& written) -> void
+{
+    spark::category* cal {nullptr};
+    tree->SetBranchAddress("Cal", &cal);
+
+    for (Long64_t entry = 0; entry < tree->GetEntries(); ++entry) {
+        tree->GetEntry(entry);
+
+        ASSERT_NE(cal, nullptr);
+        ASSERT_GT(cal->get_entries(), 0);
+        const auto event = static_cast<uint64_t>(cal->get_object_at<test_hit>(0)->value);
+        ASSERT_LT(event, written.size());
+        ASSERT_EQ(static_cast<size_t>(cal->get_entries()), hits_in_event(event));
+        ++written[event];
+    }
+
+    tree->ResetBranchAddresses();
+    delete cal;
+}
+
+/**
+ * Check that the basket sizes of the branches and their sub-branches are within the layout limits and recorded in the
+ * user info of the tree.
+ *
+ * \return bytes per event of the branches, summed over all levels
+ */
+auto check_baskets(TList* info, TObjArray* branches, const spark::writer::layout_policy& policy) -> Long64_t
+{
+    Long64_t total_bytes {0};
+    for (auto* obj : *branches) {
+        auto* branch = static_cast<TBranch*>(obj);
+        const auto basket = static_cast<size_t>(branch->GetBasketSize());
+        EXPECT_GE(basket, policy.min_basket) << branch->GetName();
+        EXPECT_LE(basket, policy.max_basket) << branch->GetName();
+
+        const auto name = std::string("layout.") + branch->GetName();
+        auto* basket_size = dynamic_cast<TParameter<Long64_t>*>(info->FindObject((name + ".basket_size").c_str()));
+        auto* bytes_per_event =
+            dynamic_cast<TParameter<Long64_t>*>(info->FindObject((name + ".bytes_per_event").c_str()));
+        EXPECT_NE(basket_size, nullptr) << branch->GetName();
+        EXPECT_NE(bytes_per_event, nullptr) << branch->GetName();
+        if (basket_size and bytes_per_event) {
+            EXPECT_EQ(basket_size->GetVal(), branch->GetBasketSize()) << branch->GetName();
+            total_bytes += bytes_per_event->GetVal();
+        }
+
+        total_bytes += check_baskets(info, branch->GetListOfBranches(), policy);
+    }
+    return total_bytes;
+}
+
+/// Check the layout recorded in the user info of the tree
+auto check_layout(TTree* tree, const spark::writer::layout_policy& policy) -> void
+{
+    auto* cluster_entries =
+        dynamic_cast<TParameter<Long64_t>*>(tree->GetUserInfo()->FindObject("layout.cluster_entries"));
+    ASSERT_NE(cluster_entries, nullptr);
+    ASSERT_GT(cluster_entries->GetVal(), 0);
+    ASSERT_EQ(cluster_entries->GetVal(), tree->GetAutoFlush());
+
+    ASSERT_GT(check_baskets(tree->GetUserInfo(), tree->GetListOfBranches(), policy), 0);
+}
+
+/**
+ * Check that the files of each stream cover consecutive entry ranges, and that the manifest file lists the same files.
+ *
+ * \return total number of entries
+ */
+auto check_manifest(const std::string& file_name, const std::vector<spark::writer::manifest_entry>& manifest)
+    -> uint64_t
+{
+    std::map<std::string, uint64_t> next_entry;
+    uint64_t total {0};
+    for (const auto& entry : manifest) {
+        EXPECT_EQ(entry.first_entry, next_entry[entry.stream]) << entry.file;
+        next_entry[entry.stream] += entry.entries;
+        total += entry.entries;
+    }
+
+    std::ifstream in(std::filesystem::path(file_name).replace_extension(".manifest"));
+    EXPECT_TRUE(in);
+
+    std::string line;
+    std::getline(in, line);
+    EXPECT_TRUE(line.starts_with('#'));
+
+    for (const auto& entry : manifest) {
+        spark::writer::manifest_entry read;
+        in >> read.file >> read.stream >> read.first_entry >> read.entries;
+        EXPECT_EQ(read.file, entry.file);
+        EXPECT_EQ(read.stream, entry.stream);
+        EXPECT_EQ(read.first_entry, entry.first_entry);
+        EXPECT_EQ(read.entries, entry.entries);
+    }
+
+    return total;
+}
+
+/// Write the input file of the pass-through tests
+auto write_pass_input(const std::string& file_name, uint64_t events) -> void
+{
+    auto setup = writer_setup(events);
+    auto writer = setup.make_writer(file_name);
+    writer.process_data(events);
+}
+}  // namespace
+
+TEST(TestsWriter, AsyncOutput)
+{
+    constexpr uint64_t n_events = 500;
+    const std::string file_name = "TestsWriter_AsyncOutput.root";
+
+    auto setup = writer_setup(n_events, 4);
+    {
+        auto writer = setup.make_writer(file_name);
+        writer.set_output_queue(2);
+        writer.process_data(n_events);
+    }
+
+    auto file = std::unique_ptr<TFile>(TFile::Open(file_name.c_str()));
+    ASSERT_TRUE(file and file->IsOpen());
+
+    auto* tree = file->Get<TTree>("T");
+    ASSERT_NE(tree, nullptr);
+    ASSERT_EQ(tree->GetEntries(), n_events);
+    check_entries(tree, 0);
+}
+
+TEST(TestsWriter, ParallelOrdered)
+{
+    constexpr uint64_t n_events = 600;
+    constexpr size_t n_workers = 3;
+    const std::string file_name = "TestsWriter_ParallelOrdered.root";
+
+    auto setup = writer_setup(n_events, n_workers + 2);
+    {
+        auto writer = setup.make_writer(file_name);
+        writer.set_workers(n_workers, spark::writer::output_order::ordered);
+        writer.process_data(n_events);
+    }
+
+    auto file = std::unique_ptr<TFile>(TFile::Open(file_name.c_str()));
+    ASSERT_TRUE(file and file->IsOpen());
+
+    auto* tree = file->Get<TTree>("T");
+    ASSERT_NE(tree, nullptr);
+    ASSERT_EQ(tree->GetEntries(), n_events);
+    // The events completed ahead of their turn are written in the input order
+    check_entries(tree, 0);
+}
+
+TEST(TestsWriter, ParallelUnordered)
+{
+    constexpr uint64_t n_events = 600;
+    constexpr size_t n_workers = 3;
+    const std::string file_name = "TestsWriter_ParallelUnordered.root";
+
+    auto setup = writer_setup(n_events, n_workers + 2);
+    {
+        auto writer = setup.make_writer(file_name);
+        writer.set_workers(n_workers, spark::writer::output_order::unordered);
+        writer.process_data(n_events);
+    }
+
+    auto file = std::unique_ptr<TFile>(TFile::Open(file_name.c_str()));
+    ASSERT_TRUE(file and file->IsOpen());
+
+    auto* tree = file->Get<TTree>("T");
+    ASSERT_NE(tree, nullptr);
+    ASSERT_EQ(tree->GetEntries(), n_events);
+
+    // The entries follow the completion of the events, each event is written once
+    std::vector<int> written(n_events, 0);
+    count_events(tree, written);
+    ASSERT_EQ(static_cast<uint64_t>(std::ranges::count(written, 1)), n_events);
+}
+
+TEST(TestsWriter, PassThroughFastClone)
+{
+    constexpr uint64_t n_events = 200;
+    const std::string input_name = "TestsWriter_PassThroughFastCloneInput.root";
+    const std::string file_name = "TestsWriter_PassThroughFastClone.root";
+
+    write_pass_input(input_name, n_events);
+
+    {
+        TChain input("T");
+        input.Add(input_name.c_str());
+
+        auto setup = writer_setup(n_events, 1, false);
+        auto writer = setup.make_writer(file_name);
+        writer.add_pass_through(&input, {WriterCategories::Cal});
+        writer.process_data(n_events);
+    }
+
+    auto in_file = std::unique_ptr<TFile>(TFile::Open(input_name.c_str()));
+    auto file = std::unique_ptr<TFile>(TFile::Open(file_name.c_str()));
+    ASSERT_TRUE(in_file and file);
+
+    auto* in_tree = in_file->Get<TTree>("T");
+    auto* tree = file->Get<TTree>("T");
+    auto* pass_tree = file->Get<TTree>("T_pass");
+    ASSERT_NE(tree, nullptr);
+    ASSERT_NE(pass_tree, nullptr);
+    ASSERT_EQ(tree->GetEntries(), n_events);
+    ASSERT_EQ(pass_tree->GetEntries(), n_events);
+    ASSERT_NE(tree->GetBranch("Raw"), nullptr);
+    ASSERT_EQ(tree->GetBranch("Cal"), nullptr);
+    ASSERT_NE(tree->GetFriend("T_pass"), nullptr);
+
+    // The baskets are copied as they are
+    ASSERT_EQ(pass_tree->GetBranch("Cal")->GetZipBytes("*"), in_tree->GetBranch("Cal")->GetZipBytes("*"));
+    ASSERT_EQ(pass_tree->GetBranch("Cal")->GetTotBytes("*"), in_tree->GetBranch("Cal")->GetTotBytes("*"));
+
+    check_entries(pass_tree, 0);
+}
+
+TEST(TestsWriter, PassThroughPartialCopy)
+{
+    constexpr uint64_t n_input = 200;
+    constexpr uint64_t n_events = 75;
+    const std::string input_name = "TestsWriter_PassThroughPartialCopyInput.root";
+    const std::string file_name = "TestsWriter_PassThroughPartialCopy.root";
+
+    write_pass_input(input_name, n_input);
+
+    {
+        TChain input("T");
+        input.Add(input_name.c_str());
+
+        auto setup = writer_setup(n_input, 1, false);
+        auto writer = setup.make_writer(file_name);
+        writer.add_pass_through(&input, {WriterCategories::Cal});
+        writer.process_data(n_events);
+    }
+
+    auto file = std::unique_ptr<TFile>(TFile::Open(file_name.c_str()));
+    ASSERT_TRUE(file);
+
+    auto* tree = file->Get<TTree>("T");
+    auto* pass_tree = file->Get<TTree>("T_pass");
+    ASSERT_NE(tree, nullptr);
+    ASSERT_NE(pass_tree, nullptr);
+    ASSERT_EQ(tree->GetEntries(), n_events);
+    ASSERT_EQ(pass_tree->GetEntries(), n_events);
+
+    check_entries(pass_tree, 0);
+}
+
+TEST(TestsWriter, PassThroughGuards)
+{
+    constexpr uint64_t n_events = 20;
+    const std::string input_name = "TestsWriter_PassThroughGuardsInput.root";
+
+    write_pass_input(input_name, n_events);
+
+    TChain input("T");
+    input.Add(input_name.c_str());
+
+    {
+        // Categories written by the tasks cannot be passed through
+        auto setup = writer_setup(n_events);
+        auto writer = setup.make_writer("TestsWriter_PassThroughGuardsWritten.root");
+        ASSERT_THROW(writer.add_pass_through(&input, {WriterCategories::Cal}), std::logic_error);
+    }
+
+    {
+        auto setup = writer_setup(n_events, 1, false);
+        auto writer = setup.make_writer("TestsWriter_PassThroughGuardsTwice.root");
+        writer.add_pass_through(&input, {WriterCategories::Cal});
+        ASSERT_THROW(writer.add_pass_through(&input, {WriterCategories::Cal}), std::logic_error);
+    }
+
+    {
+        auto setup = writer_setup(n_events, 1, false);
+        auto writer = setup.make_writer("TestsWriter_PassThroughGuardsRotation.root");
+        writer.add_pass_through(&input, {WriterCategories::Cal});
+        writer.set_rotation({.max_events = 5});
+        ASSERT_THROW(writer.process_data(n_events), std::logic_error);
+    }
+
+    {
+        auto setup = writer_setup(n_events, 2, false);
+        auto writer = setup.make_writer("TestsWriter_PassThroughGuardsIndependent.root");
+        writer.add_pass_through(&input, {WriterCategories::Cal});
+        writer.set_workers(2, spark::writer::output_order::independent);
+        ASSERT_THROW(writer.process_data(n_events), std::logic_error);
+    }
+}
+
+TEST(TestsWriter, AdaptiveLayout)
+{
+    constexpr uint64_t n_events = 1000;
+    const std::string file_name = "TestsWriter_AdaptiveLayout.root";
+
+    const auto policy = spark::writer::layout_policy {
+        .warmup_events = 100,
+        .cluster_bytes = 64 * 1024,
+        .min_basket = 4 * 1024,
+        .max_basket = 32 * 1024,
+    };
+
+    auto setup = writer_setup(n_events);
+    {
+        auto writer = setup.make_writer(file_name);
+        writer.set_layout(policy);
+        writer.process_data(n_events);
+    }
+
+    auto file = std::unique_ptr<TFile>(TFile::Open(file_name.c_str()));
+    ASSERT_TRUE(file);
+
+    auto* tree = file->Get<TTree>("T");
+    ASSERT_NE(tree, nullptr);
+    ASSERT_EQ(tree->GetEntries(), n_events);
+    check_layout(tree, policy);
+    check_entries(tree, 0);
+
+    // Invalid limits
+    auto other = writer_setup(n_events);
+    auto writer = other.make_writer("TestsWriter_AdaptiveLayoutInvalid.root");
+    ASSERT_THROW(writer.set_layout({.min_basket = 0}), std::invalid_argument);
+    ASSERT_THROW(writer.set_layout({.min_basket = 8 * 1024, .max_basket = 4 * 1024}), std::invalid_argument);
+}
+
+TEST(TestsWriter, AdaptiveLayoutRotation)
+{
+    constexpr uint64_t n_events = 1000;
+    const std::string file_name = "TestsWriter_AdaptiveLayoutRotation.root";
+
+    const auto policy = spark::writer::layout_policy {
+        .warmup_events = 100,
+        .cluster_bytes = 64 * 1024,
+        .min_basket = 4 * 1024,
+        .max_basket = 32 * 1024,
+    };
+
+    std::vector<spark::writer::manifest_entry> manifest;
+    auto setup = writer_setup(n_events);
+    {
+        auto writer = setup.make_writer(file_name);
+        writer.set_layout(policy);
+        writer.set_rotation({.max_events = 400});
+        writer.process_data(n_events);
+        manifest = writer.get_manifest();
+    }
+
+    // Each rotated file starts a new warm-up and records its own layout
+    ASSERT_EQ(manifest.size(), 3);
+    for (const auto& entry : manifest) {
+        auto file = std::unique_ptr<TFile>(TFile::Open(entry.file.c_str()));
+        ASSERT_TRUE(file) << entry.file;
+
+        auto* tree = file->Get<TTree>("T");
+        ASSERT_NE(tree, nullptr);
+        ASSERT_EQ(tree->GetEntries(), entry.entries);
+        check_layout(tree, policy);
+        check_entries(tree, entry.first_entry);
+    }
+}
+
+TEST(TestsWriter, RotatedNames)
+{
+    using spark::writer::tree;
+
+    ASSERT_EQ(tree::rotated_name("out.root", 0), "out.root");
+    ASSERT_EQ(tree::rotated_name("out.root", 1), "out_1.root");
+    ASSERT_EQ(tree::rotated_name("data/out.root", 12), "data/out_12.root");
+
+    ASSERT_EQ(tree::suffixed_name("out.root", "w0"), "out_w0.root");
+    ASSERT_EQ(tree::suffixed_name("data/run.1.root", "w3"), "data/run.1_w3.root");
+    ASSERT_EQ(tree::rotated_name(tree::suffixed_name("out.root", "w1"), 2), "out_w1_2.root");
+}
+
+TEST(TestsWriter, RotationByEvents)
+{
+    constexpr uint64_t n_events = 1000;
+    const std::string file_name = "TestsWriter_RotationByEvents.root";
+
+    std::vector<spark::writer::manifest_entry> manifest;
+    auto setup = writer_setup(n_events);
+    {
+        auto writer = setup.make_writer(file_name);
+        writer.set_rotation({.max_events = 300});
+        writer.process_data(n_events);
+        manifest = writer.get_manifest();
+    }
+
+    ASSERT_EQ(manifest.size(), 4);
+    ASSERT_EQ(check_manifest(file_name, manifest), n_events);
+
+    for (size_t i = 0; i < manifest.size(); ++i) {
+        const auto& entry = manifest[i];
+        ASSERT_EQ(entry.file, spark::writer::tree::rotated_name(file_name, i));
+        ASSERT_EQ(entry.stream, "main");
+        ASSERT_EQ(entry.first_entry, i * 300);
+        ASSERT_EQ(entry.entries, i < 3 ? 300 : 100);
+
+        auto file = std::unique_ptr<TFile>(TFile::Open(entry.file.c_str()));
+        ASSERT_TRUE(file) << entry.file;
+        ASSERT_NE(file->GetKey("FileHeader"), nullptr) << entry.file;
+
+        auto* tree = file->Get<TTree>("T");
+        ASSERT_NE(tree, nullptr);
+        ASSERT_EQ(tree->GetEntries(), entry.entries);
+        check_entries(tree, entry.first_entry);
+    }
+}
+
+TEST(TestsWriter, RotationByBytes)
+{
+    constexpr uint64_t n_events = 20000;
+    constexpr uint64_t max_bytes = 64 * 1024;
+    const std::string file_name = "TestsWriter_RotationByBytes.root";
+
+    std::vector<spark::writer::manifest_entry> manifest;
+    auto setup = writer_setup(n_events);
+    {
+        auto writer = setup.make_writer(file_name);
+        writer.set_rotation({.max_bytes = max_bytes});
+        writer.process_data(n_events);
+        manifest = writer.get_manifest();
+    }
+
+    ASSERT_GT(manifest.size(), 1);
+    ASSERT_EQ(check_manifest(file_name, manifest), n_events);
+
+    for (size_t i = 0; i < manifest.size(); ++i) {
+        const auto& entry = manifest[i];
+        ASSERT_EQ(entry.file, spark::writer::tree::rotated_name(file_name, i));
+
+        auto file = std::unique_ptr<TFile>(TFile::Open(entry.file.c_str()));
+        ASSERT_TRUE(file) << entry.file;
+        ASSERT_NE(file->GetKey("FileHeader"), nullptr) << entry.file;
+
+        auto* tree = file->Get<TTree>("T");
+        ASSERT_NE(tree, nullptr);
+        ASSERT_EQ(tree->GetEntries(), entry.entries);
+        check_entries(tree, entry.first_entry);
+    }
+}
+
+TEST(TestsWriter, IndependentWorkers)
+{
+    constexpr uint64_t n_events = 600;
+    constexpr size_t n_workers = 2;
+    const std::string file_name = "TestsWriter_IndependentWorkers.root";
+
+    std::vector<spark::writer::manifest_entry> manifest;
+    auto setup = writer_setup(n_events, n_workers + 1);
+    {
+        auto writer = setup.make_writer(file_name);
+        writer.set_workers(n_workers, spark::writer::output_order::independent);
+        writer.set_rotation({.max_events = 200});
+        writer.process_data(n_events);
+        manifest = writer.get_manifest();
+    }
+
+    ASSERT_EQ(check_manifest(file_name, manifest), n_events);
+
+    // Each event is written exactly once by one of the workers, the events of the worker files are not ordered
+    std::map<std::string, size_t> stream_files;
+    std::vector<int> written(n_events, 0);
+    for (const auto& entry : manifest) {
+        ASSERT_TRUE(entry.stream == "w0" or entry.stream == "w1") << entry.stream;
+        const auto base_name = spark::writer::tree::suffixed_name(file_name, entry.stream);
+        ASSERT_EQ(entry.file, spark::writer::tree::rotated_name(base_name, stream_files[entry.stream]++));
+
+        auto file = std::unique_ptr<TFile>(TFile::Open(entry.file.c_str()));
+        ASSERT_TRUE(file) << entry.file;
+        ASSERT_NE(file->GetKey("FileHeader"), nullptr) << entry.file;
+
+        auto* tree = file->Get<TTree>("T");
+        ASSERT_NE(tree, nullptr);
+        ASSERT_EQ(tree->GetEntries(), entry.entries);
+        count_events(tree, written);
+    }
+
+    ASSERT_EQ(static_cast<uint64_t>(std::ranges::count(written, 1)), n_events);
+
+    // The main file keeps an empty tree only
+    auto file = std::unique_ptr<TFile>(TFile::Open(file_name.c_str()));
+    ASSERT_TRUE(file);
+    auto* tree = file->Get<TTree>("T");
+    ASSERT_NE(tree, nullptr);
+    ASSERT_EQ(tree->GetEntries(), 0);
+}
+
+TEST(TestsWriter, NtupleRoundTrip)
+{
+    constexpr uint64_t n_events = 500;
+    const std::string file_name = "TestsWriter_NtupleRoundTrip.root";
+
+    auto setup = writer_setup(n_events);
+    {
+        auto writer = setup.sprk.create_writer<spark::writer::ntuple>("N", file_name, 0);
+        writer.process_data(n_events);
+    }
+
+    auto reader = ROOT::RNTupleReader::Open("N", file_name);
+    ASSERT_EQ(reader->GetNEntries(), n_events);
+
+    // The objects are stored by value in columns, with the positions alongside
+    auto hits = reader->GetView<std::vector<test_hit>>("Cal");
+    auto positions = reader->GetView<std::vector<std::uint64_t>>("Cal_pos");
+    for (auto entry : reader->GetEntryRange()) {
+        const auto& event_hits = hits(entry);
+        const auto& event_positions = positions(entry);
+        ASSERT_EQ(event_hits.size(), hits_in_event(entry));
+        ASSERT_EQ(event_positions.size(), event_hits.size());
+        for (size_t i = 0; i < event_hits.size(); ++i) {
+            ASSERT_EQ(event_hits[i].value, static_cast<int>(entry));
+            ASSERT_EQ(event_positions[i], i);
+        }
+    }
+}
+
+TEST(TestsWriter, NtupleRoundTripParallel)
+{
+    constexpr uint64_t n_events = 500;
+    constexpr size_t n_workers = 2;
+    const std::string file_name = "TestsWriter_NtupleRoundTripParallel.root";
+
+    auto setup = writer_setup(n_events, n_workers + 1);
+    {
+        auto writer = setup.sprk.create_writer<spark::writer::ntuple>("N", file_name, 0);
+        writer.set_workers(n_workers);
+        writer.process_data(n_events);
+    }
+
+    auto reader = ROOT::RNTupleReader::Open("N", file_name);
+    ASSERT_EQ(reader->GetNEntries(), n_events);
+
+    // The entries follow the completion of the clusters, each event is written once
+    std::vector<int> written(n_events, 0);
+    auto hits = reader->GetView<std::vector<test_hit>>("Cal");
+    auto positions = reader->GetView<std::vector<std::uint64_t>>("Cal_pos");
+    for (auto entry : reader->GetEntryRange()) {
+        const auto& event_hits = hits(entry);
+        ASSERT_FALSE(event_hits.empty());
+
+        const auto event = static_cast<uint64_t>(event_hits[0].value);
+        ASSERT_LT(event, n_events);
+        ASSERT_EQ(event_hits.size(), hits_in_event(event));
+        ASSERT_EQ(positions(entry).size(), event_hits.size());
+        ++written[event];
+    }
+
+    ASSERT_EQ(static_cast<uint64_t>(std::ranges::count(written, 1)), n_events);
+}